@@ -59,16 +59,16 @@ void Cluster::dext(Time t, Time /* e */, const Bag& msgs)
                     data.cluster_index = _number;
                     _data.push_back(data);
 
-#ifdef WITH_TRACE_MODEL
-                    Trace::trace() << TraceElement(get_name(), t,
-                                                   artis::common::DELTA_EXT)
-                                   << "full: " << data.stack_index << " [ ";
-                    for (unsigned int i = 0; i < 5; ++i) {
-                        Trace::trace() << data.destination[i] << " ";
+                    if (traced()) {
+                        std::vector < double > fields = {
+                            (double)data.stack_index,
+                            (double)data.cluster_index };
+
+                        fields.insert(fields.end(), data.destination,
+                                      data.destination + 5);
+                        trace(t, artis::common::DELTA_EXT, TRACE_CLUSTER_FULL,
+                              fields);
                     }
-                    Trace::trace() << "] - " << data.cluster_index;
-                    Trace::trace().flush();
-#endif
 
                     ++_full_stack_number;
                     if (_full_stack_number == _stack_indexes.size()) {
@@ -81,12 +81,10 @@ void Cluster::dext(Time t, Time /* e */, const Bag& msgs)
 
                 e.data()(data);
 
-#ifdef WITH_TRACE_MODEL
-                Trace::trace() << TraceElement(get_name(), t,
-                                               artis::common::DELTA_EXT)
-                               << "empty: " << data.stack_index;
-                Trace::trace().flush();
-#endif
+                if (traced()) {
+                    trace(t, artis::common::DELTA_EXT, TRACE_CLUSTER_EMPTY,
+                          { (double)data.stack_index });
+                }
 
                 --_full_stack_number;
                 if (_full_stack_number == 0) {
@@ -102,6 +100,7 @@ Time Cluster::start(Time /* t */)
     _phase = WAIT;
     _full_stack_number = 0;
     _full = false;
+    _data.clear();
     return infinity;
 }
 
@@ -114,22 +113,19 @@ Time Cluster::ta(Time /* t */) const
     }
 }
 
-Bag Cluster::lambda(Time /* t */) const
+void Cluster::lambda(Time /* t */, Sink& sink) const
 {
-    Bag msgs;
-
     if (_phase == SEND_FULL) {
         for (std::vector < FullData >::const_iterator it = _data.begin();
              it != _data.end(); ++it) {
-            msgs.push_back(ExternalEvent(OUT_FULL, *it));
+            sink.emit(OUT_FULL, *it);
         }
     } else if (_phase == SEND_EMPTY) {
         for (std::vector < FullData >::const_iterator it = _data.begin();
              it != _data.end(); ++it) {
-            msgs.push_back(ExternalEvent(OUT_EMPTY, *it));
+            sink.emit(OUT_EMPTY, *it);
         }
     }
-    return msgs;
 }
 
 } // namespace cc
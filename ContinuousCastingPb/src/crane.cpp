@@ -26,6 +26,8 @@
 
 namespace cc {
 
+constexpr artis::common::OutPort < Slab > Crane::OUT_SLAB;
+
 Crane::Crane(const std::string& name,
              const Context < Crane, CraneParameters >& context) :
     artis::pdevs::Dynamics < artis::common::DoubleTime, Crane,
@@ -45,7 +47,7 @@ Crane::Crane(const std::string& name,
         output_port({ TAKE + i, (boost::format("take_%1%") % i).str() });
     }
     for (unsigned int i = 1; i <= _destination_number; ++i) {
-        output_port({ OUT + i, (boost::format("out_%1%") % i).str() });
+        output_port(OUT_SLAB + i, (boost::format("out_%1%") % i).str());
     }
     observables({ { MOVE_NUMBER, "move_number" },
             { SLAB_NUMBER, "slab_number" } });
@@ -154,16 +156,16 @@ void Crane::dext(Time t, Time e, const Bag& msgs)
                 event.data()(data);
                 _datas[data.cluster_index - 1].push_back(data);
 
-#ifdef WITH_TRACE_MODEL
-                Trace::trace() << TraceElement(get_name(), t,
-                                               artis::common::DELTA_EXT)
-                               << "full: " << data.stack_index << " [ ";
-                for (unsigned int i = 0; i < _destination_number; ++i) {
-                    Trace::trace() << data.destination[i] << " ";
+                if (traced()) {
+                    std::vector < double > fields = {
+                        (double)data.stack_index, (double)data.cluster_index,
+                        (double)_phase };
+
+                    fields.insert(fields.end(), data.destination,
+                                  data.destination + _destination_number);
+                    trace(t, artis::common::DELTA_EXT, TRACE_CRANE_FULL,
+                          fields);
                 }
-                Trace::trace() << "] - " << data.cluster_index << " " << _phase;
-                Trace::trace().flush();
-#endif
 
                 ++_full_stack_numbers[data.cluster_index - 1];
                 if (_full_stack_numbers[data.cluster_index - 1] ==
@@ -183,12 +185,10 @@ void Crane::dext(Time t, Time e, const Bag& msgs)
                 event.data()(slab);
                 _current_slabs.push_back(slab);
 
-#ifdef WITH_TRACE_MODEL
-        Trace::trace() << TraceElement(get_name(), t,
-                                       artis::common::DELTA_EXT)
-                       << "in -> " << slab.index << " " << _phase;
-        Trace::trace().flush();
-#endif
+                if (traced()) {
+                    trace(t, artis::common::DELTA_EXT, TRACE_CRANE_IN,
+                          { (double)slab.index, (double)_phase });
+                }
 
                 _phase = MOVE_TO_STOCK;
                 _sigma = _move_duration;
@@ -197,13 +197,10 @@ void Crane::dext(Time t, Time e, const Bag& msgs)
 
                 event.data()(data);
 
-#ifdef WITH_TRACE_MODEL
-                Trace::trace() << TraceElement(get_name(), t,
-                                               artis::common::DELTA_EXT)
-                               << "empty -> " << data.stack_index << " "
-                               << _phase;
-                Trace::trace().flush();
-#endif
+                if (traced()) {
+                    trace(t, artis::common::DELTA_EXT, TRACE_CRANE_EMPTY,
+                          { (double)data.stack_index, (double)_phase });
+                }
 
                 --_full_stack_numbers[_full_cluster_index - 1];
             }
@@ -215,8 +212,14 @@ Time Crane::start(Time /* t */)
     _phase = WAIT;
     _sigma = infinity;
     _full_cluster_index = 0;
+    _taken_slab_number = 0;
     _move_number = 0;
     _slab_number = 0;
+    _current_slabs.clear();
+    for (unsigned int i = 0; i < _datas.size(); ++i) {
+        _datas[i].clear();
+    }
+    _full_stack_numbers.clear();
     for (unsigned int i = 0; i < _stack_index_by_cluster.size(); ++i) {
         _full_stack_numbers.push_back(0);
     }
@@ -228,36 +231,29 @@ Time Crane::ta(Time /* t */) const
     return _sigma;
 }
 
-Bag Crane::lambda(Time t) const
+void Crane::lambda(Time t, Sink& sink) const
 {
-    Bag msgs;
-
     if (_phase == SEND_TAKE) {
         const FullData& data = _datas[_full_cluster_index - 1].back();
 
-#ifdef WITH_TRACE_MODEL
-        Trace::trace() << TraceElement(get_name(), t, artis::common::LAMBDA)
-                       << "take: stack_" << data.stack_index << " "
-                       << _taken_slab_number << " slabs";
-        Trace::trace().flush();
-#endif
+        if (traced()) {
+            trace(t, artis::common::LAMBDA, TRACE_CRANE_TAKE,
+                  { (double)data.stack_index, (double)_taken_slab_number });
+        }
 
-        msgs.push_back(ExternalEvent(TAKE + data.stack_index,
-                                     _taken_slab_number));
+        sink.emit(TAKE + data.stack_index, _taken_slab_number);
     } else if (_phase == SEND_DELIVER) {
         for (Slabs::const_iterator it = _current_slabs.begin();
              it != _current_slabs.end(); ++it) {
 
-#ifdef WITH_TRACE_MODEL
-            Trace::trace() << TraceElement(get_name(), t, artis::common::LAMBDA)
-                           << "out: " << it->destination;
-            Trace::trace().flush();
-#endif
+            if (traced()) {
+                trace(t, artis::common::LAMBDA, TRACE_CRANE_OUT,
+                      { (double)it->destination });
+            }
 
-            msgs.push_back(ExternalEvent(OUT + it->destination, *it));
+            sink.emit(OUT_SLAB + it->destination, *it);
         }
     }
-    return msgs;
 }
 
 Value Crane::observe(const Time& /* t */, unsigned int index) const
@@ -44,6 +44,9 @@ public:
     enum outputs { TAKE = 1, OUT = 100 };
     enum vars { MOVE_NUMBER, SLAB_NUMBER };
 
+    // slabs delivered to the stocks: OUT_SLAB + i
+    static constexpr artis::common::OutPort < Slab > OUT_SLAB = { OUT };
+
     Crane(const std::string& name,
           const Context < Crane, CraneParameters >& context);
 
@@ -53,11 +56,20 @@ public:
     void dext(Time t, Time e, const Bag& msgs);
     Time start(Time t);
     Time ta(Time t) const;
-    artis::common::Bag < artis::common::DoubleTime > lambda(
-        Time t) const;
+    void lambda(Time t, Sink& sink) const;
 
     Value observe(const Time& /* t */, unsigned int /* index */) const;
 
+    unsigned int move_number() const
+    { return _move_number; }
+
+    unsigned int slab_number() const
+    { return _slab_number; }
+
+    // no cluster to empty
+    bool waiting() const
+    { return _phase == WAIT; }
+
 private:
     void select_stack();
     void remove_slabs();
@@ -1,30 +1,276 @@
-
 #include <evalCC.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
 namespace cc {
 
+Evaluator::Evaluator() :
+    _rc(0, 4800, "root", _parameters, artis::common::NoParameters()),
+    _observed(false), _share_prefixes(false), _interval(16),
+    _checkpoint_number(0)
+{
+    update_cascades();
+}
+
+void Evaluator::update_cascades() {
+    _rc.root().set_zero_time_cascades(not _observed and not _share_prefixes);
+}
+
+void Evaluator::share_prefixes(bool share, unsigned int interval) {
+    _share_prefixes = share;
+    _interval = interval > 0 ? interval : 1;
+    _checkpoint_number = 0;
+    update_cascades();
+}
+
+int Evaluator::restart(const Solution & solution, unsigned int seed) const {
+    if (_checkpoint_number == 0 or seed != _parameters.seed or
+        solution.size() != _parameters.preferences.size()) {
+        return -1;
+    }
+
+    // the first reads of the last run: the runs are the same until the
+    // first selection reading a different preference
+    const std::vector<unsigned int> & first_reads =
+        _rc.root().get_graph_manager().get_cc().get_gantry_crane().
+        first_reads();
+    unsigned int decision = GantryCrane::NOT_READ;
+
+    for (size_t i = 0; i < solution.size(); ++i) {
+        if (solution[i] != _parameters.preferences[i] and
+            first_reads[i] < decision) {
+            decision = first_reads[i];
+        }
+    }
+
+    int index = (int)_checkpoint_number - 1;
+
+    while (index >= 0 and _checkpoints[index].decision > decision) {
+        --index;
+    }
+    return index;
+}
+
+template < class Stop >
+void Evaluator::simulate(const Solution & solution, unsigned int seed,
+                         Stop stop) {
+    if (not _share_prefixes) {
+        // same size after the first run: no reallocation
+        _parameters.preferences.assign(solution.begin(), solution.end());
+        _parameters.seed = seed;
+        _rc.run(stop);
+        return;
+    }
+
+    const GantryCrane & gantry_crane =
+        _rc.root().get_graph_manager().get_cc().get_gantry_crane();
+    int index = restart(solution, seed);
+    auto checkpoint = [&](Time tn) {
+        if (gantry_crane.delivering() and
+            (_checkpoint_number == 0 or
+             _checkpoints[_checkpoint_number - 1].decision + _interval <=
+             gantry_crane.decision_number())) {
+            if (_checkpoint_number == _checkpoints.size()) {
+                _checkpoints.push_back(Checkpoint());
+            }
+
+            Checkpoint & c = _checkpoints[_checkpoint_number];
+
+            // else retried at the next step
+            if (_rc.save(c.snapshot)) {
+                c.decision = gantry_crane.decision_number();
+                ++_checkpoint_number;
+            }
+        }
+        return stop(tn);
+    };
+
+    _parameters.preferences.assign(solution.begin(), solution.end());
+    _parameters.seed = seed;
+    if (index < 0) {
+        _checkpoint_number = 0;
+        _rc.run(checkpoint);
+    } else {
+        _checkpoint_number = index + 1;
+        _rc.restore(_checkpoints[index].snapshot);
+        _rc.resume(checkpoint);
+    }
+}
+
+int Evaluator::run(const Solution & solution, unsigned int seed) {
+    simulate(solution, seed, [](Time /* tn */) { return false; });
+    return crane().move_number();
+}
+
+Evaluator::Evaluation Evaluator::run(const Solution & solution,
+                                     unsigned int seed, int bound) {
+    const SubGraphManager & cc = _rc.root().get_graph_manager().get_cc();
+    const Crane & crane = cc.get_crane();
+    const GantryCrane & gantry_crane = cc.get_gantry_crane();
+    const RunOutTable & table1 = cc.get_run_out_table(1);
+    const RunOutTable & table2 = cc.get_run_out_table(2);
+    Status status = COMPLETED;
+    // time of the last step
+    Time t = -infinity;
+
+    simulate(solution, seed, [&](Time tn) {
+            // no other zero-time step at t (always true with the cascades
+            // made by the root): the state is stable
+            bool stable = tn > t;
+
+            t = tn;
+            if ((int)crane.move_number() > bound) {
+                status = CUTOFF;
+            } else if (table1.failed() or table2.failed() or
+                       (stable and gantry_crane.failed() and
+                        crane.waiting())) {
+                // the gantry crane only starts again when the crane
+                // empties a cluster
+                status = DEADLOCK;
+            }
+            return status != COMPLETED;
+        });
+
+    return { (int)crane.move_number(), status };
+}
+
+void Evaluator::attachView(const std::string & name, cc::View * view) {
+    _rc.attachView(name, view);
+    _observed = true;
+    update_cascades();
+}
+
+EvalCC::EvalCC(unsigned int seed, unsigned int thread_number,
+               size_t cache_capacity) :
+    _seed(seed), _thread_number(thread_number > 0 ? thread_number : 1),
+    _cutoff(false), _bound(0), _share_prefixes(false), _interval(16),
+    _evaluators(_thread_number),
+    _cache(cache_capacity)
+{ }
+
+void EvalCC::cutoff(int bound) {
+    _cutoff = true;
+    _bound = bound;
+}
+
+void EvalCC::no_cutoff() {
+    _cutoff = false;
+}
+
+void EvalCC::share_prefixes(bool share, unsigned int interval) {
+    _share_prefixes = share;
+    _interval = interval;
+    for (auto & evaluator : _evaluators) {
+        if (evaluator) {
+            evaluator->share_prefixes(share, interval);
+        }
+    }
+}
+
+Evaluator & EvalCC::evaluator(unsigned int index) {
+    if (not _evaluators[index]) {
+        _evaluators[index].reset(new Evaluator());
+        _evaluators[index]->share_prefixes(_share_prefixes, _interval);
+    }
+    return *_evaluators[index];
+}
+
+int EvalCC::fitness(Evaluator & evaluator, const Solution & solution,
+                    unsigned int seed) {
+    int fitness;
+
+    if (not _cache.find(solution, context(seed), fitness)) {
+        fitness = simulate(evaluator, solution, seed);
+        _cache.insert(solution, context(seed), fitness,
+                      evaluator.read_preferences());
+    }
+    return fitness;
+}
+
+int EvalCC::simulate(Evaluator & evaluator, const Solution & solution,
+                     unsigned int seed) {
+    if (not _cutoff) {
+        return evaluator.run(solution, seed);
+    }
+
+    Evaluator::Evaluation evaluation = evaluator.run(solution, seed, _bound);
+
+    switch (evaluation.status) {
+    case Evaluator::CUTOFF: return PENALTY + evaluation.move_number;
+    case Evaluator::DEADLOCK: return 2 * PENALTY;
+    default: return evaluation.move_number;
+    }
+}
+
+template < class Task >
+void EvalCC::parallel(size_t n, Task task) {
+    // each worker owns an evaluator: the workers only share the index
+    // of the next task
+    std::atomic<size_t> next(0);
+    auto worker = [&task, &next, n](unsigned int index) {
+        size_t i;
+
+        while ((i = next++) < n) {
+            task(i, index);
+        }
+    };
+    unsigned int thread_number = std::min<size_t>(_thread_number, n);
+    std::vector<std::thread> threads;
+
+    for (unsigned int i = 1; i < thread_number; ++i) {
+        threads.push_back(std::thread(worker, i));
+    }
+    worker(0);
+    for (std::thread & thread : threads) {
+        thread.join();
+    }
+}
+
 void EvalCC::operator()(Solution & solution) {
-    GlobalParameters p;
+    evaluate(solution, 0);
+}
 
-    p.preferences = solution;
+void EvalCC::operator()(Solution & solution, const Solution & parent) {
+    evaluate(solution, parent, 0);
+}
 
-    artis::common::RootCoordinator <
-        DoubleTime, artis::pdevs::Coordinator <
-            DoubleTime,
-            RootGraphManager,
-            GlobalParameters >
-        > rc(0, 4800, "root", p, artis::common::NoParameters());
+void EvalCC::evaluate(Solution & solution, unsigned int worker) {
+    assert(worker < _thread_number);
 
-    rc.attachView("CC", new ::MyView());
+    solution.fitness(fitness(evaluator(worker), solution, _seed));
+}
 
-    rc.run();
+void EvalCC::evaluate(Solution & solution, const Solution & parent,
+                      unsigned int worker) {
+    int fitness;
 
-    const ::MyView::Values& values = rc.observer().view("CC").get("Crane:moveNumber");
-    int move_number;
+    if (_cache.find_neighbour(solution, parent, context(_seed), fitness)) {
+        solution.fitness(fitness);
+    } else {
+        evaluate(solution, worker);
+    }
+}
 
-    values.back().second(move_number);
+void EvalCC::evaluate(std::vector<Solution> & solutions) {
+    parallel(solutions.size(), [this, &solutions](size_t i,
+                                                  unsigned int worker) {
+            solutions[i].fitness(fitness(evaluator(worker), solutions[i],
+                                         _seed));
+        });
+}
 
-    solution.fitness(move_number);
+void EvalCC::replicate(const Solution & solution, unsigned int first,
+                       unsigned int last, std::vector<int> & fitnesses) {
+    if (fitnesses.size() < last) {
+        fitnesses.resize(last);
+    }
+    parallel(last - first, [this, &solution, &fitnesses, first](
+                 size_t i, unsigned int worker) {
+            fitnesses[first + i] = fitness(evaluator(worker), solution,
+                                           _seed + first + i);
+        });
 }
 
 } // namespace cc
@@ -1,6 +1,7 @@
 #ifndef _evalCC_hpp
 #define _evalCC_hpp
 
+#include <fitness_cache.hpp>
 #include <graph_manager.hpp>
 #include <models.hpp>
 
@@ -8,6 +9,10 @@
 
 #include <solution.hpp>
 
+#include <memory>
+#include <thread>
+#include <vector>
+
 using namespace cc;
 using namespace artis::common;
 
@@ -27,14 +32,220 @@ public:
     }
 };
 
+/**
+ * Long-lived simulation of the coupled model: the graph is built once and
+ * each run only reinitializes the models and replaces the preferences.
+ * An evaluator must be used by one thread at a time.
+ *
+ * No view is attached by default: the fitness is read on the crane at the
+ * end of the run. Views (MyView for instance) are only attached for
+ * diagnostic runs.
+ *
+ * Until a view is attached or the prefixes are shared, the root makes
+ * the zero-time cascades itself (see
+ * pdevs::Coordinator::set_zero_time_cascades): the cutoff only checks the
+ * state at the end of the cascades.
+ */
+class Evaluator
+{
+public:
+    enum Status { COMPLETED, CUTOFF, DEADLOCK };
+
+    struct Evaluation
+    {
+        int    move_number;
+        Status status;
+    };
+
+    Evaluator();
+
+    // simulate the solution and return the number of crane moves
+    int run(const Solution & /* solution */, unsigned int /* seed */) ;
+
+    /**
+     * same as run() but the simulation is aborted as soon as the number of
+     * crane moves exceeds bound (CUTOFF) or the plant deadlocks (DEADLOCK):
+     * a slab missed its deadline on a run-out table or the gantry crane
+     * failed while the crane has no cluster left to empty
+     */
+    Evaluation run(const Solution & /* solution */, unsigned int /* seed */,
+                   int /* bound */) ;
+
+    // record time series at each step of the next runs
+    void attachView(const std::string & /* name */, cc::View * /* view */) ;
+
+    /**
+     * keep a checkpoint of each run before one stack selection in interval:
+     * the next run with the same seed restarts from the last checkpoint
+     * before its first stack selection reading a different preference
+     * instead of t = 0. The views record the steps of the resumed runs only.
+     */
+    void share_prefixes(bool /* share */, unsigned int /* interval */ = 16) ;
+
+    const artis::observer::Observer<DoubleTime> & observer() const
+    { return _rc.observer(); }
+
+    // final state of the crane after a run
+    const Crane & crane() const
+    { return _rc.root().get_graph_manager().get_cc().get_crane(); }
+
+    // flags of the preferences read by the last run
+    const std::vector<bool> & read_preferences() const
+    { return _rc.root().get_graph_manager().get_cc().get_gantry_crane().
+            read_preferences(); }
+
+private:
+    typedef artis::common::RootCoordinator <
+        DoubleTime, PDEVSCoordinator < RootGraphManager > > RootCoordinator;
+
+    // state before a stack selection
+    struct Checkpoint
+    {
+        unsigned int                    decision;
+        artis::common::Snapshot<DoubleTime> snapshot;
+    };
+
+    template < class Stop >
+    void simulate(const Solution & /* solution */, unsigned int /* seed */,
+                  Stop /* stop */) ;
+
+    // index of the checkpoint to restart from or -1
+    int restart(const Solution & /* solution */, unsigned int /* seed */) const ;
+
+    // the views and the checkpoints need every step
+    void update_cascades() ;
+
+    // must be declared before the coordinator which keeps its address
+    GlobalParameters _parameters;
+    RootCoordinator  _rc;
+
+    bool                    _observed;
+    bool                    _share_prefixes;
+    unsigned int            _interval;
+    // checkpoints of the last run, the next ones are reused
+    std::vector<Checkpoint> _checkpoints;
+    size_t                  _checkpoint_number;
+};
+
 class EvalCC
 {
 public:
+    /**
+     * seed: seed of the random streams of each simulation run
+     * thread_number: number of threads used by the batch evaluation
+     * cache_capacity: number of fitnesses kept to answer the evaluations
+     *   of the same solutions without simulation (0: no cache)
+     */
+    EvalCC(unsigned int seed = 5489,
+           unsigned int thread_number = std::thread::hardware_concurrency(),
+           size_t cache_capacity = 4096);
+
+    // fitness of the aborted runs: penalty + number of moves at the abort
+    // for a cutoff, 2 * penalty for a deadlock
+    static const int PENALTY = 100000;
+
+    // bound never reached by the crane: only the deadlocks are aborted
+    static const int NO_BOUND = PENALTY - 1;
 
     void operator()(Solution & /* solution */) ;
 
+    /**
+     * evaluate a neighbour of an evaluated solution: if they only differ on
+     * preferences the evaluation of parent did not read, the simulations
+     * are the same and the fitness of parent is given without simulation
+     */
+    void operator()(Solution & /* solution */, const Solution & /* parent */) ;
+
+    /**
+     * evaluate all the solutions, the simulations are spread over
+     * the threads and each one sets the fitness of its solution
+     */
+    void evaluate(std::vector<Solution> & /* solutions */) ;
+
+    /**
+     * same as operator() on the evaluator of a worker thread (worker <
+     * thread_number): the workers evaluate their solutions concurrently
+     */
+    void evaluate(Solution & /* solution */, unsigned int /* worker */) ;
+
+    void evaluate(Solution & /* solution */, const Solution & /* parent */,
+                  unsigned int /* worker */) ;
+
+    unsigned int thread_number() const
+    { return _thread_number; }
+
+    /**
+     * fitnesses of the replications [first, last) of the solution, spread
+     * over the threads. The replication r is simulated with the seed
+     * seed + r whatever the solution (common random numbers): the
+     * fitnesses of two solutions are paired. The replication 0 is the
+     * evaluation of operator().
+     */
+    void replicate(const Solution & /* solution */, unsigned int /* first */,
+                   unsigned int /* last */, std::vector<int> & /* fitnesses */) ;
+
+    /**
+     * abort the next evaluations as soon as the number of crane moves exceeds
+     * bound (typically the fitness of the incumbent) or the plant deadlocks
+     * and give them a penalized fitness. By default, all the simulations run
+     * until the end.
+     */
+    void cutoff(int /* bound */) ;
+
+    // all the simulations run until the end
+    void no_cutoff() ;
+
+    // the runs are aborted beyond a number of moves, not only on deadlocks
+    bool bounded() const
+    { return _cutoff and _bound < NO_BOUND; }
+
+    /**
+     * each thread restarts its simulations from the common prefix with its
+     * previous simulation (see Evaluator::share_prefixes), the fitnesses
+     * are unchanged
+     */
+    void share_prefixes(bool /* share */, unsigned int /* interval */ = 16) ;
+
+    // the fitness is a penalty: the evaluation has been aborted
+    static bool aborted(const Solution & solution)
+    { return solution.fitness() >= PENALTY; }
+
+    // hit and miss counters
+    const FitnessCache & cache() const
+    { return _cache; }
+
+private:
+    Evaluator & evaluator(unsigned int /* index */) ;
+
+    EvaluationContext context(unsigned int seed) const
+    { return { seed, _cutoff, _bound }; }
+
+    // fitness in the current context, from the cache if possible
+    int fitness(Evaluator & /* evaluator */, const Solution & /* solution */,
+                unsigned int /* seed */) ;
+
+    int simulate(Evaluator & /* evaluator */, const Solution & /* solution */,
+                 unsigned int /* seed */) ;
+
+    // task(i, worker) for i in [0, n), spread over the threads
+    template < class Task >
+    void parallel(size_t /* n */, Task /* task */) ;
+
+    unsigned int _seed;
+    unsigned int _thread_number;
+    bool         _cutoff;
+    int          _bound;
+    bool         _share_prefixes;
+    unsigned int _interval;
+
+    // one evaluator per thread, built on first use and kept between calls
+    std::vector<std::unique_ptr<Evaluator> > _evaluators;
+
+    // the cutoff is a part of the key: the same solution has another
+    // fitness if it is aborted
+    FitnessCache _cache;
 };
 
 } // namespace cc
 
-#endif
\ No newline at end of file
+#endif
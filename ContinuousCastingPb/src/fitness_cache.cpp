@@ -0,0 +1,179 @@
+#include <fitness_cache.hpp>
+
+#include <algorithm>
+
+namespace cc {
+
+FitnessCache::FitnessCache(size_t capacity) :
+    _capacity(capacity), _hand(0), _hits(0), _misses(0),
+    _neighbour_hits(0)
+{
+    _entries.reserve(_capacity);
+}
+
+std::uint64_t FitnessCache::hash(const Solution & solution,
+                                 const EvaluationContext & context) {
+    // FNV-1a on 32 bits words
+    const std::uint64_t prime = 1099511628211ULL;
+    std::uint64_t h = 14695981039346656037ULL;
+
+    for (unsigned int x : solution) {
+        h = (h ^ x) * prime;
+    }
+    h = (h ^ context.seed) * prime;
+    if (context.cutoff) {
+        h = (h ^ (unsigned int)context.bound) * prime;
+        h = (h ^ 1) * prime;
+    }
+    return h;
+}
+
+FitnessCache::Entry * FitnessCache::entry(std::uint64_t h,
+                                          const Solution & solution,
+                                          const EvaluationContext & context) {
+    auto it = _index.find(h);
+
+    if (it != _index.end()) {
+        Entry & entry = _entries[it->second];
+
+        if (entry.context == context and
+            entry.preferences.size() == solution.size() and
+            std::equal(solution.begin(), solution.end(),
+                       entry.preferences.begin())) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool FitnessCache::find(const Solution & solution,
+                        const EvaluationContext & context, int & fitness) {
+    std::uint64_t h = hash(solution, context);
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry * e = entry(h, solution, context);
+
+    if (e) {
+        e->referenced = true;
+        fitness = e->fitness;
+        ++_hits;
+        return true;
+    }
+    ++_misses;
+    return false;
+}
+
+bool FitnessCache::find_neighbour(const Solution & solution,
+                                  const Solution & parent,
+                                  const EvaluationContext & context,
+                                  int & fitness) {
+    if (solution.size() != parent.size()) {
+        return false;
+    }
+
+    std::uint64_t h = hash(parent, context);
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry * e = entry(h, parent, context);
+
+    if (e == nullptr or e->read_preferences.size() != parent.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < solution.size(); ++i) {
+        if (solution[i] != parent[i] and e->read_preferences[i]) {
+            return false;
+        }
+    }
+    e->referenced = true;
+    fitness = e->fitness;
+    ++_neighbour_hits;
+
+    // the copy is needed: the entry of the parent may be replaced
+    std::vector<bool> read_preferences = e->read_preferences;
+
+    store(hash(solution, context), solution, context, fitness,
+          read_preferences);
+    return true;
+}
+
+void FitnessCache::insert(const Solution & solution,
+                          const EvaluationContext & context, int fitness,
+                          const std::vector<bool> & read_preferences) {
+    std::uint64_t h = hash(solution, context);
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    store(h, solution, context, fitness, read_preferences);
+}
+
+void FitnessCache::store(std::uint64_t h, const Solution & solution,
+                         const EvaluationContext & context, int fitness,
+                         const std::vector<bool> & read_preferences) {
+    if (_capacity == 0) {
+        return;
+    }
+
+    auto it = _index.find(h);
+    size_t slot;
+
+    if (it != _index.end()) {
+        // same solution evaluated by two threads or collision
+        slot = it->second;
+    } else if (_entries.size() < _capacity) {
+        slot = _entries.size();
+        _entries.push_back(Entry());
+        _index[h] = slot;
+    } else {
+        while (_entries[_hand].referenced) {
+            _entries[_hand].referenced = false;
+            _hand = (_hand + 1) % _capacity;
+        }
+        slot = _hand;
+        _hand = (_hand + 1) % _capacity;
+        _index.erase(_entries[slot].hash);
+        _index[h] = slot;
+    }
+
+    Entry & entry = _entries[slot];
+
+    entry.hash = h;
+    entry.preferences.assign(solution.begin(), solution.end());
+    entry.context = context;
+    entry.fitness = fitness;
+    entry.read_preferences = read_preferences;
+    entry.referenced = false;
+}
+
+void FitnessCache::clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _entries.clear();
+    _index.clear();
+    _hand = 0;
+    _hits = 0;
+    _misses = 0;
+    _neighbour_hits = 0;
+}
+
+size_t FitnessCache::hits() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    return _hits;
+}
+
+size_t FitnessCache::misses() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    return _misses;
+}
+
+size_t FitnessCache::neighbour_hits() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    return _neighbour_hits;
+}
+
+size_t FitnessCache::size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    return _entries.size();
+}
+
+} // namespace cc
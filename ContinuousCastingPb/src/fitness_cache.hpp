@@ -0,0 +1,105 @@
+#ifndef _fitness_cache_hpp
+#define _fitness_cache_hpp
+
+#include <solution.hpp>
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace cc {
+
+/**
+ * Settings of an evaluation which, with the solution, determine its fitness
+ */
+struct EvaluationContext
+{
+    unsigned int seed;
+    bool         cutoff;
+    int          bound;
+
+    bool operator==(const EvaluationContext & other) const
+    { return seed == other.seed and cutoff == other.cutoff and
+            (not cutoff or bound == other.bound); }
+};
+
+/**
+ * Bounded memory of the evaluated solutions shared by the threads.
+ * The entries are found by a hash of the preferences and of the context,
+ * the full key is compared to ignore the collisions. When the cache is
+ * full, an entry not found since the last turn of the clock is replaced.
+ *
+ * Each entry also keeps the preferences read by the simulation: a
+ * neighbour which only differs on other preferences runs the same
+ * simulation and has the same fitness.
+ */
+class FitnessCache
+{
+public:
+    // capacity = 0: nothing is kept
+    FitnessCache(size_t capacity);
+
+    // true and the fitness if the solution has been evaluated in the context
+    bool find(const Solution & /* solution */,
+              const EvaluationContext & /* context */, int & /* fitness */) ;
+
+    /**
+     * true and the fitness of parent if parent has been evaluated in the
+     * context and solution only differs from it on preferences that
+     * evaluation did not read, solution is then inserted too
+     */
+    bool find_neighbour(const Solution & /* solution */,
+                        const Solution & /* parent */,
+                        const EvaluationContext & /* context */,
+                        int & /* fitness */) ;
+
+    void insert(const Solution & /* solution */,
+                const EvaluationContext & /* context */, int /* fitness */,
+                const std::vector<bool> & /* read_preferences */) ;
+
+    void clear() ;
+
+    size_t hits() const ;
+    size_t misses() const ;
+    // neighbours answered by find_neighbour
+    size_t neighbour_hits() const ;
+    size_t size() const ;
+
+private:
+    struct Entry
+    {
+        std::uint64_t               hash;
+        std::vector<unsigned int>   preferences;
+        EvaluationContext           context;
+        int                         fitness;
+        std::vector<bool>           read_preferences;
+        // found since the last turn of the clock hand
+        bool                        referenced;
+    };
+
+    static std::uint64_t hash(const Solution & /* solution */,
+                              const EvaluationContext & /* context */) ;
+
+    // entry of the solution or nullptr, the mutex must be locked
+    Entry * entry(std::uint64_t /* hash */, const Solution & /* solution */,
+                  const EvaluationContext & /* context */) ;
+
+    // the mutex must be locked
+    void store(std::uint64_t /* hash */, const Solution & /* solution */,
+               const EvaluationContext & /* context */, int /* fitness */,
+               const std::vector<bool> & /* read_preferences */) ;
+
+    size_t                                    _capacity;
+    std::vector<Entry>                        _entries;
+    std::unordered_map<std::uint64_t, size_t> _index;
+    size_t                                    _hand;
+    size_t                                    _hits;
+    size_t                                    _misses;
+    size_t                                    _neighbour_hits;
+    mutable std::mutex                        _mutex;
+};
+
+} // namespace cc
+
+#endif
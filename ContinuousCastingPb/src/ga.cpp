@@ -0,0 +1,276 @@
+/**
+ * @file ga.cpp
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * Copyright (C) 2017-2018 ULCO http://www.univ-litoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <solution.hpp>
+#include <evalCC.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+using namespace cc;
+
+namespace {
+
+// constants related to the dimension of the optimization problem
+const unsigned int n_stack = 5;
+const unsigned int n_destination = 8;
+const unsigned int solution_size =
+    n_destination + n_stack * n_destination * (n_destination - 1);
+const unsigned int max_preference = 100;
+
+/**
+ * Steady-state genetic algorithm with asynchronous evaluations: each worker
+ * builds a child from the current population as soon as its previous child
+ * is evaluated and the child replaces the worst solution if it is not
+ * worse. The fitness (number of crane moves, a penalty for a deadlocked
+ * plant) is minimized.
+ */
+class SteadyStateGA
+{
+public:
+    SteadyStateGA(EvalCC & eval, unsigned int population_size,
+                  unsigned int seed) :
+        _eval(eval), _population_size(population_size), _seed(seed),
+        _max_evaluation_number(0), _evaluation_number(0), _aborted_number(0),
+        _stop(false)
+    { }
+
+    // stops after time_limit seconds or max_evaluation_number evaluations
+    // (0: no limit)
+    void run(double time_limit, unsigned long max_evaluation_number)
+    {
+        std::vector<std::thread> workers;
+
+        _max_evaluation_number = max_evaluation_number;
+        _start = std::chrono::steady_clock::now();
+        init();
+        for (unsigned int i = 0; i < _eval.thread_number(); ++i) {
+            workers.push_back(std::thread(&SteadyStateGA::worker, this, i));
+        }
+        while (not _stop and elapsed() < time_limit) {
+            double remaining = (time_limit - elapsed()) * 1000;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(
+                    (long)std::min(1000., remaining) + 1));
+
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            report(' ');
+        }
+        _stop = true;
+        for (std::thread & worker : workers) {
+            worker.join();
+        }
+        report(' ');
+        std::cout << "# " << _evaluation_number << " evaluations in "
+                  << elapsed() << " s: " << (_evaluation_number / elapsed())
+                  << " evaluations/s, " << _aborted_number << " aborted"
+                  << std::endl;
+        std::cout << "# cache: " << _eval.cache().hits() << " hits, "
+                  << _eval.cache().neighbour_hits() << " neighbour hits, "
+                  << _eval.cache().misses() << " misses" << std::endl;
+        std::cout << _best.to_string() << std::endl;
+    }
+
+private:
+    double elapsed() const
+    {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - _start).count();
+    }
+
+    // random population evaluated by all the workers
+    void init()
+    {
+        std::mt19937 rng(_seed);
+        std::uniform_int_distribution<unsigned int> preference(
+            0, max_preference - 1);
+
+        _population.resize(_population_size);
+        for (Solution & s : _population) {
+            s.resize(solution_size);
+            for (unsigned int & x : s) {
+                x = preference(rng);
+            }
+        }
+        _eval.evaluate(_population);
+        _evaluation_number = _population_size;
+        _best = _population[0];
+        for (const Solution & s : _population) {
+            if (EvalCC::aborted(s)) {
+                ++_aborted_number;
+            }
+            if (s.fitness() < _best.fitness()) {
+                _best = s;
+            }
+        }
+        std::cout << "# time evaluations evaluations/s aborted best"
+                  << std::endl;
+        report('*');
+    }
+
+    // the mutex must be locked
+    void report(char mark) const
+    {
+        double t = elapsed();
+
+        std::cout << mark << " " << t << " " << _evaluation_number << " "
+                  << (t > 0 ? _evaluation_number / t : 0) << " "
+                  << _aborted_number << " " << _best.fitness() << std::endl;
+    }
+
+    // binary tournament, the mutex must be locked
+    const Solution & select(std::mt19937 & rng) const
+    {
+        std::uniform_int_distribution<size_t> index(0, _population.size() - 1);
+        const Solution & a = _population[index(rng)];
+        const Solution & b = _population[index(rng)];
+
+        return a.fitness() <= b.fitness() ? a : b;
+    }
+
+    // uniform crossover and mutation, the mutex must be locked
+    void breed(std::mt19937 & rng, Solution & child, Solution & parent) const
+    {
+        std::uniform_real_distribution<double> probability(0, 1);
+        std::uniform_int_distribution<unsigned int> preference(
+            0, max_preference - 1);
+        const Solution & other = select(rng);
+
+        parent = select(rng);
+        child = parent;
+        if (probability(rng) < crossover_rate) {
+            for (size_t i = 0; i < child.size(); ++i) {
+                if (probability(rng) < 0.5) {
+                    child[i] = other[i];
+                }
+            }
+        }
+        for (unsigned int & x : child) {
+            if (probability(rng) < 1. / solution_size) {
+                x = preference(rng);
+            }
+        }
+    }
+
+    // replace the worst solution, the mutex must be locked
+    void insert(const Solution & child)
+    {
+        size_t worst = 0;
+
+        for (size_t i = 1; i < _population.size(); ++i) {
+            if (_population[i].fitness() > _population[worst].fitness()) {
+                worst = i;
+            }
+        }
+        if (child.fitness() <= _population[worst].fitness()) {
+            _population[worst] = child;
+        }
+        if (child.fitness() < _best.fitness()) {
+            _best = child;
+            report('*');
+        }
+    }
+
+    void worker(unsigned int index)
+    {
+        std::mt19937 rng(_seed + index + 1);
+        Solution child;
+        Solution parent;
+
+        while (not _stop) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                breed(rng, child, parent);
+            }
+            // the evaluation of the parent is reused if the child only
+            // differs on preferences it did not read
+            _eval.evaluate(child, parent, index);
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                ++_evaluation_number;
+                if (EvalCC::aborted(child)) {
+                    ++_aborted_number;
+                }
+                insert(child);
+                if (_max_evaluation_number > 0 and
+                    _evaluation_number >= _max_evaluation_number) {
+                    _stop = true;
+                }
+            }
+        }
+    }
+
+    static constexpr double crossover_rate = 0.9;
+
+    EvalCC &                  _eval;
+    unsigned int              _population_size;
+    unsigned int              _seed;
+    unsigned long             _max_evaluation_number;
+
+    std::vector<Solution>     _population;
+    Solution                  _best;
+    unsigned long             _evaluation_number;
+    // children given a penalty (deadlocked plants)
+    unsigned long             _aborted_number;
+    std::atomic<bool>         _stop;
+    std::mutex                _mutex;
+    std::chrono::steady_clock::time_point _start;
+};
+
+constexpr double SteadyStateGA::crossover_rate;
+
+} // namespace
+
+// usage: cc-ga [seconds [threads [population [seed [max evaluations]]]]]
+int main(int argc, char** argv)
+{
+    double time_limit = argc > 1 ? std::atof(argv[1]) : 60;
+    unsigned int thread_number = argc > 2 ? std::atoi(argv[2]) :
+        std::thread::hardware_concurrency();
+    unsigned int population_size = argc > 3 ? std::atoi(argv[3]) : 64;
+    unsigned int seed = argc > 4 ? std::atoi(argv[4]) : 1;
+    unsigned long max_evaluation_number = argc > 5 ? std::atol(argv[5]) : 0;
+
+    // the simulations of a worker restart from the prefix shared with its
+    // previous child
+    EvalCC eval(5489, thread_number);
+
+    eval.share_prefixes(true);
+    // a deadlocked plant stops moving slabs and would have the best fitness:
+    // the cutoff gives it a penalty and its bound is never reached by the
+    // crane, so the other runs are not aborted
+    eval.cutoff(EvalCC::NO_BOUND);
+
+    SteadyStateGA ga(eval, population_size > 1 ? population_size : 2, seed);
+
+    ga.run(time_limit, max_evaluation_number);
+    return 0;
+}
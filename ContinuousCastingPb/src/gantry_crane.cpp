@@ -33,9 +33,9 @@ GantryCrane::GantryCrane(const std::string& name,
     artis::pdevs::Dynamics < artis::common::DoubleTime,
                              GantryCrane,
                              GantryCraneParameters >(name, context),
-    _slab(nullptr), _stack_number(context.parameters().stack_number),
+    _stack_number(context.parameters().stack_number),
     _cluster_number(context.parameters().cluster_number),
-    _preferences(context.parameters().preferences)
+    _global(context.parameters().global)
 {
     input_ports({ { ARRIVED, "arrived" }, { NEW, "new" },
                   { FULL, "full" }, { EMPTY, "empty" } });
@@ -47,11 +47,7 @@ GantryCrane::GantryCrane(const std::string& name,
 }
 
 GantryCrane::~GantryCrane()
-{
-    if (_slab) {
-        delete _slab;
-    }
-}
+{ }
 
 bool GantryCrane::all_stacks_are_full()
 {
@@ -63,6 +59,17 @@ bool GantryCrane::all_stacks_are_full()
     return n == _stack_number;
 }
 
+const unsigned int GantryCrane::NOT_READ;
+
+double GantryCrane::preference(unsigned int index)
+{
+    _read_preferences[index] = true;
+    if (_first_reads[index] == NOT_READ) {
+        _first_reads[index] = _decision_number;
+    }
+    return _global->preferences[index];
+}
+
 bool GantryCrane::select_stack(Time t)
 {
     if (not all_stacks_are_full()) {
@@ -96,7 +103,7 @@ bool GantryCrane::select_stack(Time t)
             // update the highest score taking care of equality
             if ((size < 5) && width_check) {
                 if (size == 0) {
-                    current_score = _preferences[ _slab->destination ];
+                    current_score = preference(_slab->destination);
                     //std::cout << "(" << current_score << ")" ;
                 }
                 else {
@@ -106,10 +113,11 @@ bool GantryCrane::select_stack(Time t)
                         + (_slab->destination - 1);
                     std::cout << "(" << size << " " << _stacked_slabs[i][size - 1].destination << " " << _slab->destination << " " << tmp << ", " << _preferences[tmp] << ")" ;
                     */
-                    current_score = _preferences[
-                        n_destination
+                    unsigned int index = n_destination
                         + (size * n_destination + (_stacked_slabs[i][size - 1].destination - 1)) * (n_destination - 1) 
-                        + (_slab->destination - 1) ];
+                        + (_slab->destination - 1);
+
+                    current_score = preference(index);
                     // bonus for close widths
                     current_score += 0.5 - std::abs(_stacked_slabs[i][size - 1].width - _slab->width) / 2000. ;
                 }
@@ -141,16 +149,16 @@ bool GantryCrane::select_stack(Time t)
 
             _stacked_slabs[_selected_stack_index - 1].push_back(*_slab);
 
-#ifdef WITH_TRACE_MODEL
-            Trace::trace() << TraceElement(get_name(), t,
-                                           artis::common::DELTA_INT)
-                           << "select -> ";
-            for (std::vector < Slabs >::const_iterator it =
-                     _stacked_slabs.begin(); it != _stacked_slabs.end(); ++it) {
-                Trace::trace() << it->to_string() << " ";
+            if (traced()) {
+                std::vector < double > fields;
+
+                for (std::vector < Slabs >::const_iterator it =
+                         _stacked_slabs.begin(); it != _stacked_slabs.end();
+                     ++it) {
+                    it->trace_fields(fields);
+                }
+                trace(t, artis::common::DELTA_INT, TRACE_SELECT, fields);
             }
-            Trace::trace().flush();
-#endif
 
             return true;
         }
@@ -174,17 +182,17 @@ void GantryCrane::dint(Time t)
             _sigma = 0.5;
         }
     } else if (_phase == DELIVER) {
-        if (select_stack(t)) {
+        bool selected = select_stack(t);
+
+        ++_decision_number;
+        if (selected) {
             _phase = SEND_OUT;
             _sigma = 0;
         } else {
 
-#ifdef WITH_TRACE_MODEL
-            Trace::trace() << TraceElement(get_name(), t,
-                                           artis::common::DELTA_INT)
-                           << "FAILED";
-            Trace::trace().flush();
-#endif
+            if (traced()) {
+                trace(t, artis::common::DELTA_INT, TRACE_FAILED);
+            }
 
             // TODO: make a choice between 1 or 2
             _fail_cluster_index = _rand.getInt(1, 2);
@@ -192,8 +200,7 @@ void GantryCrane::dint(Time t)
             _sigma = 0;
         }
     } else if (_phase == SEND_OUT) {
-        delete _slab;
-        _slab = nullptr;
+        _slab = boost::none;
         if (_next_slabs.empty()) {
             _phase = WAIT;
             _sigma = infinity;
@@ -213,15 +220,13 @@ void GantryCrane::dext(Time t, Time e, const Bag& msgs)
                       const ExternalEvent &event) {
             if (event.on_port(NEW)) {
                 if (_phase != FAIL) {
-                    _slab = new Slab;
+                    _slab = Slab();
                     event.data()(*_slab);
 
-#ifdef WITH_TRACE_MODEL
-                    Trace::trace() << TraceElement(get_name(), t,
-                                                   artis::common::DELTA_EXT)
-                                   << "new -> " << _slab->to_string();
-                    Trace::trace().flush();
-#endif
+                    if (traced()) {
+                        trace(t, artis::common::DELTA_EXT, TRACE_NEW_SLAB,
+                              _slab->trace_fields());
+                    }
 
                     _phase = DELIVER;
                     _sigma = 0.5;
@@ -233,12 +238,10 @@ void GantryCrane::dext(Time t, Time e, const Bag& msgs)
                     event.data()(next_slab);
                     _next_slabs.push_back(next_slab);
 
-#ifdef WITH_TRACE_MODEL
-                    Trace::trace() << TraceElement(get_name(), t,
-                                                   artis::common::DELTA_EXT)
-                                   << "arrived -> " << next_slab.to_string();
-                    Trace::trace().flush();
-#endif
+                    if (traced()) {
+                        trace(t, artis::common::DELTA_EXT, TRACE_ARRIVED_SLAB,
+                              next_slab.trace_fields());
+                    }
 
                     if (_phase == WAIT) {
                         _phase = SLAB_ARRIVED;
@@ -252,12 +255,10 @@ void GantryCrane::dext(Time t, Time e, const Bag& msgs)
 
                 event.data()(data);
 
-#ifdef WITH_TRACE_MODEL
-                Trace::trace() << TraceElement(get_name(), t,
-                                               artis::common::DELTA_EXT)
-                               << "full -> " << data.stack_index;
-                Trace::trace().flush();
-#endif
+                if (traced()) {
+                    trace(t, artis::common::DELTA_EXT, TRACE_FULL_STACK,
+                          { (double)data.stack_index });
+                }
 
                 _full_clusters[data.cluster_index - 1] = true;
             } else if (event.on_port(EMPTY)) {
@@ -265,12 +266,10 @@ void GantryCrane::dext(Time t, Time e, const Bag& msgs)
 
                 event.data()(data);
 
-#ifdef WITH_TRACE_MODEL
-                Trace::trace() << TraceElement(get_name(), t,
-                                               artis::common::DELTA_EXT)
-                               << "empty -> " << data.stack_index;
-                Trace::trace().flush();
-#endif
+                if (traced()) {
+                    trace(t, artis::common::DELTA_EXT, TRACE_EMPTY_STACK,
+                          { (double)data.stack_index });
+                }
 
                 _full_clusters[data.cluster_index - 1] = false;
                 _stacked_slabs[data.stack_index - 1].clear();
@@ -286,10 +285,17 @@ Time GantryCrane::start(Time /* t */)
 {
     _phase = WAIT;
     _sigma = infinity;
+    _rand.seed(_global->seed, 0);
+    _read_preferences.assign(_global->preferences.size(), false);
+    _first_reads.assign(_global->preferences.size(), NOT_READ);
+    _decision_number = 0;
+    _slab = boost::none;
+    _next_slabs.clear();
     _full_clusters.clear();
     for (unsigned int i = 0; i < _cluster_number; ++i) {
         _full_clusters.push_back(false);
     }
+    _stacked_slabs.clear();
     for (unsigned int i = 0; i < _stack_number; ++i) {
         _stacked_slabs.push_back(Slabs());
     }
@@ -301,40 +307,33 @@ Time GantryCrane::ta(Time /* t */) const
     return _sigma;
 }
 
-Bag GantryCrane::lambda(Time t) const
+void GantryCrane::lambda(Time t, Sink& sink) const
 {
-    Bag msgs;
-
     if (_phase == SEND_TAKE) {
         Slab next_slab = _next_slabs[_next_slabs.size() - 1];
 
-#ifdef WITH_TRACE_MODEL
-        Trace::trace() << TraceElement(get_name(), t, artis::common::LAMBDA)
-                       << "take: " << next_slab.table_number;
-        Trace::trace().flush();
-#endif
+        if (traced()) {
+            trace(t, artis::common::LAMBDA, TRACE_TAKE_NUMBER,
+                  { (double)next_slab.table_number });
+        }
 
-        msgs.push_back(ExternalEvent(TAKE, next_slab.table_number));
+        sink.emit(TAKE, next_slab.table_number);
     } else if (_phase == SEND_OUT) {
 
-#ifdef WITH_TRACE_MODEL
-        Trace::trace() << TraceElement(get_name(), t, artis::common::LAMBDA)
-                       << "out: " << _slab->to_string();
-        Trace::trace().flush();
-#endif
+        if (traced()) {
+            trace(t, artis::common::LAMBDA, TRACE_OUT_SLAB,
+                  _slab->trace_fields());
+        }
 
-        msgs.push_back(ExternalEvent(OUT + _selected_stack_index, *_slab));
+        sink.emit(OUT + _selected_stack_index, *_slab);
     } else if (_phase == SEND_FAIL) {
 
-#ifdef WITH_TRACE_MODEL
-        Trace::trace() << TraceElement(get_name(), t, artis::common::LAMBDA)
-                       << "fail";
-        Trace::trace().flush();
-#endif
+        if (traced()) {
+            trace(t, artis::common::LAMBDA, TRACE_FAIL);
+        }
 
-        msgs.push_back(ExternalEvent(OUT_FAIL + _fail_cluster_index, 0));
+        sink.emit(OUT_FAIL + _fail_cluster_index, 0);
     }
-    return msgs;
 }
 
 } // namespace cc
@@ -25,13 +25,17 @@
 
 #include <models.hpp>
 
+#include <boost/optional.hpp>
+
+#include <limits>
+
 namespace cc {
 
 struct GantryCraneParameters
 {
-    unsigned int                 cluster_number;
-    unsigned int                 stack_number;
-    std::vector < unsigned int > preferences;
+    unsigned int            cluster_number;
+    unsigned int            stack_number;
+    const GlobalParameters* global;
 };
 
 class GantryCrane : public artis::pdevs::Dynamics < artis::common::DoubleTime,
@@ -51,15 +55,39 @@ public:
     void dext(Time t, Time /* e */, const Bag& msgs);
     Time start(Time /* t */);
     Time ta(Time /* t */) const;
-    artis::common::Bag < artis::common::DoubleTime > lambda(
-        Time /* t */) const;
+    void lambda(Time /* t */, Sink& sink) const;
 
     Value observe(const Time& /* t */, unsigned int /* index */) const
     { return artis::common::Value(); }
 
+    // no stack can receive the current slab
+    bool failed() const
+    { return _phase == FAIL; }
+
+    // flags of the preferences used by the stack selections of the run
+    const std::vector < bool >& read_preferences() const
+    { return _read_preferences; }
+
+    // a stack selection is pending
+    bool delivering() const
+    { return _phase == DELIVER; }
+
+    // number of stack selections done
+    unsigned int decision_number() const
+    { return _decision_number; }
+
+    // for each preference, the stack selection which has read it first or
+    // NOT_READ
+    const std::vector < unsigned int >& first_reads() const
+    { return _first_reads; }
+
+    static const unsigned int NOT_READ =
+        std::numeric_limits < unsigned int >::max();
+
 private:
     bool select_stack(Time t);
     bool all_stacks_are_full();
+    double preference(unsigned int index);
 
     enum Phase { SLAB_ARRIVED, DELIVER, FAIL, SEND_FAIL, SEND_OUT, SEND_TAKE,
                  WAIT };
@@ -67,7 +95,8 @@ private:
     // state
     Phase                _phase;
     Time                 _sigma;
-    Slab*                _slab; // current slab processing by gantry crane
+    boost::optional < Slab > _slab; // current slab processing by gantry
+                                    // crane
     std::vector < Slab > _next_slabs; // list of arrived slabs to
                                       // runout table
     std::vector < bool > _full_clusters; // full flags of cluster
@@ -75,11 +104,16 @@ private:
                                                 // stack
     std::vector < Slabs > _stacked_slabs;
     unsigned int          _fail_cluster_index;
+    cc::utils::Rand       _rand;
+    std::vector < bool >  _read_preferences;
+    std::vector < unsigned int > _first_reads;
+    unsigned int          _decision_number;
 
     // parameters
     unsigned int         _stack_number; // number of stacks
     unsigned int         _cluster_number; // number of clusters
-    std::vector < unsigned int > _preferences; // preferences to select stack
+    const GlobalParameters* _global; // preferences to select stack and
+                                     // seed of the current run
 };
 
 } // namespace cc
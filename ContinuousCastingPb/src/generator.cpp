@@ -21,10 +21,7 @@
  */
 
 #include <generator.hpp>
-
-#include <fstream>
-#include <boost/algorithm/string.hpp>
-#include <boost/lexical_cast.hpp>
+#include <slab_catalog.hpp>
 
 namespace cc {
 
@@ -33,76 +30,11 @@ Generator::Generator(const std::string& name,
                      context) :
     artis::pdevs::Dynamics < artis::common::DoubleTime,
                              Generator, GeneratorParameters >(name, context),
-    _cc_index(context.parameters().cc_index),
-    _start_indexes(context.parameters().start_indexes)
+    _sequence(&SlabCatalog::catalog().sequence(
+                  context.parameters().cc_index,
+                  context.parameters().start_indexes))
 {
     output_port({ OUT, "out" });
-
-    std::ifstream f("../data/input.csv");
-    std::vector < std::string > columns;
-    char line[256];
-    unsigned int index = 0;
-    unsigned int stack_index = _start_indexes[index];
-    double timestamp = -1;
-
-    do {
-        f.getline(line, 256);
-
-        std::string l = line;
-
-        boost::split(columns, l, boost::is_any_of(";"));
-
-        if (columns.size() == 10) {
-            unsigned int cc_index = boost::lexical_cast < int >(columns[0]);
-
-            if (cc_index == _cc_index) {
-                bool ok = true;
-                unsigned int current_index =
-                    boost::lexical_cast < int >(columns[2]);
-
-                if (stack_index == current_index) {
-                    ++stack_index;
-                } else if (index < _start_indexes.size() - 1 and
-                           current_index == _start_indexes[index + 1]) {
-                    ++index;
-                    stack_index = _start_indexes[index] + 1;
-                } else {
-                    ok = false;
-                }
-                if (ok) {
-                    double current_length =
-                        boost::lexical_cast < double >(columns[7]);
-                    double current_width =
-                        boost::lexical_cast < double >(columns[8]);
-                    double current_timestamp =
-                        boost::lexical_cast < double >(columns[1]);
-                    char current_destination =
-                        boost::lexical_cast < char >(columns[5]);
-                    double duration;
-
-                    if (timestamp == -1) {
-                        duration = 0;
-                    } else {
-                        duration = (current_timestamp - timestamp) * 24 * 60;
-                    }
-                    timestamp = current_timestamp;
-
-                    Slab slab;
-
-                    slab.length = current_length;
-                    slab.width = current_width;
-                    // Minus A char value (65) and adding 1 to get valid destination
-                    slab.destination = current_destination - 64;
-                    slab.index = current_index;
-                    slab.cc_number = _cc_index;
-                    _slabs.push_back(slab);
-
-                    _durations.push_back(duration);
-                }
-            }
-        }
-    } while (not f.eof());
-    f.close();
 }
 
 Generator::~Generator()
@@ -112,11 +44,12 @@ void Generator::dint(Time /* t */)
 {
     if (_phase == SEND) {
  //        _next_time = t + _rand.normal(5, 0.5);
-        _next_time = _durations[_index];
+        _next_time = _sequence->durations[_index];
         _phase = WAIT;
     } else if (_phase == WAIT) {
-        _phase = SEND;
         ++_index;
+        // the sequence of the caster is exhausted
+        _phase = _index < _sequence->slabs.size() ? SEND : END;
     }
 }
 
@@ -128,7 +61,7 @@ Time Generator::start(Time /* t */)
     _phase = WAIT;
     _index = 0;
 //    _next_time = t + _rand.normal(3, 0.5);
-    _next_time = _durations[_index];
+    _next_time = _sequence->durations[_index];
     return _next_time;
 }
 
@@ -136,30 +69,28 @@ Time Generator::ta(Time /* t */) const
 {
     if (_phase == WAIT) {
         return _next_time;
+    } else if (_phase == END) {
+        return infinity;
     } else {
         return 0;
     }
 }
 
-Bag Generator::lambda(Time t) const
+void Generator::lambda(Time t, Sink& sink) const
 {
-    Bag msgs;
-
     if (_phase == SEND) {
-        Slab slab = _slabs[_index];
+        Slab slab = _sequence->slabs[_index];
 
         slab.table_number = -1;
         slab.max_date = -1;
 
-#ifdef WITH_TRACE_MODEL
-        Trace::trace() << TraceElement(get_name(), t, artis::common::LAMBDA)
-                       << "out: " << slab.to_string();
-        Trace::trace().flush();
-#endif
+        if (traced()) {
+            trace(t, artis::common::LAMBDA, TRACE_OUT_SLAB,
+                  slab.trace_fields());
+        }
 
-        msgs.push_back(ExternalEvent(OUT, slab));
+        sink.emit(OUT, slab);
     }
-    return msgs;
 }
 
 } // namespace cc
@@ -27,6 +27,8 @@
 
 namespace cc {
 
+struct SlabSequence;
+
 struct GeneratorParameters
 {
     unsigned int cc_index;
@@ -48,13 +50,13 @@ public:
     void dext(Time /* t */, Time /* e */, const Bag& /* msgs */);
     Time start(Time t);
     Time ta(Time t) const;
-    Bag lambda(Time /* t */) const;
+    void lambda(Time /* t */, Sink& sink) const;
 
     Value observe(const Time& /* t */, unsigned int /* index */) const
     { return artis::common::Value(); }
 
 private:
-    enum Phase { WAIT, SEND };
+    enum Phase { WAIT, SEND, END };
 
     // state
     Phase        _phase;
@@ -62,10 +64,7 @@ private:
     double       _next_time;
 
     // parameters
-    unsigned int                 _cc_index;
-    std::vector < unsigned int > _start_indexes;
-    Slabs                        _slabs;
-    std::vector < double >       _durations;
+    const SlabSequence* _sequence; // view on the shared slab catalog
 };
 
 } // namespace cc
@@ -40,16 +40,14 @@
 
 namespace cc {
 
-struct GlobalParameters
-{
-    std::vector < unsigned int > preferences;
-};
-
 typedef artis::common::Coordinator <
     artis::common::DoubleTime > Coordinator;
-template < class T >
+// the events of the simultaneous models are ordered as their children
+typedef artis::common::IndexedSchedulerType Scheduler;
+template < class T, class EventTable = Scheduler >
 using PDEVSCoordinator = artis::pdevs::Coordinator <
-    artis::common::DoubleTime, T, GlobalParameters >;
+    artis::common::DoubleTime, T, GlobalParameters,
+    artis::common::NoParameters, EventTable >;
 typedef artis::pdevs::GraphManager <
     artis::common::DoubleTime, GlobalParameters > GraphManager;
 template < class Dyn, class T >
@@ -65,42 +63,22 @@ public:
                      STACK = 10, STOCK = 20 };
 
     SubGraphManager(Coordinator* coordinator,
-                    const GlobalParameters parameters,
+                    const GlobalParameters& parameters,
                     const NoParameters& graph_parameters) :
+        SubGraphManager(coordinator, parameters, graph_parameters,
+                        caster_21(1), caster_21(2))
+    { }
+
+protected:
+    // plant of a caster whose two strands are cast by g1 and g2
+    SubGraphManager(Coordinator* coordinator,
+                    const GlobalParameters& parameters,
+                    const NoParameters& graph_parameters,
+                    const GeneratorParameters& p1,
+                    const GeneratorParameters& p2) :
         GraphManager(coordinator, parameters, graph_parameters)
     {
         {
-            GeneratorParameters p1;
-            GeneratorParameters p2;
-
-            p1.cc_index = 21;
-            p1.start_indexes = { 2249240, 2249259, 2264121, 2264227, 2264333,
-                                 2264539, 2264746, 2264952, 2265157, 2265122,
-                                 2265226, 2265638, 2265845, 2265951, 2266158,
-                                 2266122, 2266159, 2267261, 2267466, 2267572,
-                                 2267777, 2267982, 2268088, 2268293, 2268761,
-                                 2269167, 2269374, 2269581, 2269687, 2269894,
-                                 2269862, 2270063, 2270059, 2270661, 2270968,
-                                 2271176, 2271383, 2271692, 2271898, 2271862,
-                                 2272068, 2274461, 2274668, 2274875, 2275082,
-                                 2275190, 2275362, 2275359, 2275399, 2276461,
-                                 2276668, 2276875, 2277082, 2277189, 2277199,
-                                 2281021, 2281227, 2281435, 2281643, 2281751,
-                                 2282022, 2282229, };
-            p2.cc_index = 21;
-            p2.start_indexes = { 2249277, 2249299, 2264161, 2264266, 2264372,
-                                 2264577, 2264783, 2264988, 2265194, 2265162,
-                                 2265263, 2265674, 2265880, 2265986, 2266192,
-                                 2266199, 2267221, 2267426, 2267532, 2267737,
-                                 2267942, 2268048, 2268253, 2268721, 2269127,
-                                 2269335, 2269543, 2269649, 2269856, 2269822,
-                                 2270026, 2270099, 2270621, 2270928, 2271135,
-                                 2271344, 2271652, 2271622, 2271823, 2272059,
-                                 2272099, 2274421, 2274628, 2274836, 2275043,
-                                 2275150, 2275357, 2275322, 2275366, 2276421,
-                                 2276628, 2276836, 2277043, 2277148, 2277159,
-                                 2281061, 2281267, 2281475, 2281682, 2281789,
-                                 2282096, 2282062, 2282267, };
             generator1 = new artis::pdevs::Simulator <
                 artis::common::DoubleTime, Generator,
                 GeneratorParameters >("g1", p1);
@@ -116,7 +94,7 @@ public:
 
             p.cluster_number = 2;
             p.stack_number = 5;
-            p.preferences = parameters.preferences;
+            p.global = &parameters;
             gantryCrane = new artis::pdevs::Simulator <
                 artis::common::DoubleTime, GantryCrane,
                 GantryCraneParameters >("gc", p);
@@ -127,7 +105,9 @@ public:
             RunOutTableParameters p2;
 
             p1.number = 1;
+            p1.global = &parameters;
             p2.number = 2;
+            p2.global = &parameters;
             runOutTable1 = new artis::pdevs::Simulator <
                 artis::common::DoubleTime, RunOutTable,
                 RunOutTableParameters >("r1", p1);
@@ -235,7 +215,7 @@ public:
 
                 stocks.push_back(simulator);
                 add_children(STOCK, simulator);
-                out({ crane, Crane::OUT + i }) >> in({ simulator, Stock::IN });
+                out(crane, Crane::OUT_SLAB + i) >> in(simulator, Stock::IN_SLAB);
             }
         }
 
@@ -264,6 +244,17 @@ public:
         out({ cluster2, Cluster::OUT_EMPTY }) >> in({ crane, Crane::EMPTY });
     }
 
+public:
+    const Crane& get_crane() const
+    { return crane->dynamics(); }
+
+    const GantryCrane& get_gantry_crane() const
+    { return gantryCrane->dynamics(); }
+
+    const RunOutTable& get_run_out_table(unsigned int number) const
+    { return number == 1 ? runOutTable1->dynamics() :
+            runOutTable2->dynamics(); }
+
     virtual ~SubGraphManager()
     {
         delete generator1;
@@ -290,6 +281,45 @@ public:
         stocks.clear();
     }
 
+protected:
+    // start indexes of the strands of caster 21, validated against the
+    // plant: SlabCatalog::strands() does not rebuild them
+    static GeneratorParameters caster_21(unsigned int strand)
+    {
+        GeneratorParameters p1;
+        GeneratorParameters p2;
+
+        p1.cc_index = 21;
+        p1.start_indexes = { 2249240, 2249259, 2264121, 2264227, 2264333,
+                             2264539, 2264746, 2264952, 2265157, 2265122,
+                             2265226, 2265638, 2265845, 2265951, 2266158,
+                             2266122, 2266159, 2267261, 2267466, 2267572,
+                             2267777, 2267982, 2268088, 2268293, 2268761,
+                             2269167, 2269374, 2269581, 2269687, 2269894,
+                             2269862, 2270063, 2270059, 2270661, 2270968,
+                             2271176, 2271383, 2271692, 2271898, 2271862,
+                             2272068, 2274461, 2274668, 2274875, 2275082,
+                             2275190, 2275362, 2275359, 2275399, 2276461,
+                             2276668, 2276875, 2277082, 2277189, 2277199,
+                             2281021, 2281227, 2281435, 2281643, 2281751,
+                             2282022, 2282229, };
+        p2.cc_index = 21;
+        p2.start_indexes = { 2249277, 2249299, 2264161, 2264266, 2264372,
+                             2264577, 2264783, 2264988, 2265194, 2265162,
+                             2265263, 2265674, 2265880, 2265986, 2266192,
+                             2266199, 2267221, 2267426, 2267532, 2267737,
+                             2267942, 2268048, 2268253, 2268721, 2269127,
+                             2269335, 2269543, 2269649, 2269856, 2269822,
+                             2270026, 2270099, 2270621, 2270928, 2271135,
+                             2271344, 2271652, 2271622, 2271823, 2272059,
+                             2272099, 2274421, 2274628, 2274836, 2275043,
+                             2275150, 2275357, 2275322, 2275366, 2276421,
+                             2276628, 2276836, 2277043, 2277148, 2277159,
+                             2281061, 2281267, 2281475, 2281682, 2281789,
+                             2282096, 2282062, 2282267, };
+        return strand == 1 ? p1 : p2;
+    }
+
 private:
     artis::pdevs::Simulator < artis::common::DoubleTime, Generator,
                                  GeneratorParameters >* generator1;
@@ -316,36 +346,48 @@ private:
         artis::common::DoubleTime,
         Cluster, ClusterParameters >* cluster2;
 
-    artis::pdevs::Simulator <
-        artis::common::DoubleTime,
-        Crane, CraneParameters >* crane;
-
     std::vector < artis::pdevs::Simulator <
                       artis::common::DoubleTime,
                       Stock, StockParameters >* > stocks;
+
+protected:
+    artis::pdevs::Simulator <
+        artis::common::DoubleTime,
+        Crane, CraneParameters >* crane;
 };
 
-class RootGraphManager : public GraphManager
+// EventTable: scheduler of the events of the plant models, the root
+// coordinator must use it too since the hierarchy is flattened
+template < class EventTable >
+class BasicRootGraphManager : public GraphManager
 {
 public:
     enum submodels { CC };
 
-    RootGraphManager(Coordinator* coordinator,
-                     const GlobalParameters parameters,
-                     const NoParameters& graph_parameters) :
+    BasicRootGraphManager(Coordinator* coordinator,
+                          const GlobalParameters& parameters,
+                          const NoParameters& graph_parameters) :
         GraphManager(coordinator, parameters, graph_parameters),
         S("CC", parameters, graph_parameters)
     {
         add_child(CC, &S);
+        // the plant models are simulated by the root coordinator, S is
+        // only kept for the structure
+        flatten();
     }
 
-    virtual ~RootGraphManager()
+    virtual ~BasicRootGraphManager()
     { }
 
+    const SubGraphManager& get_cc() const
+    { return S.get_graph_manager(); }
+
 private:
-    PDEVSCoordinator < SubGraphManager > S;
+    PDEVSCoordinator < SubGraphManager, EventTable > S;
 };
 
+typedef BasicRootGraphManager < Scheduler > RootGraphManager;
+
 } // namespace cc
 
 #endif
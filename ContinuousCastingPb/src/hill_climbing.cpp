@@ -0,0 +1,178 @@
+/**
+ * @file hill_climbing.cpp
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * Copyright (C) 2017-2018 ULCO http://www.univ-litoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <evalCC.hpp>
+#include <racing.hpp>
+#include <solution.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+
+using namespace cc;
+
+namespace {
+
+// constants related to the dimension of the optimization problem
+const unsigned int n_stack = 5;
+const unsigned int n_destination = 8;
+const unsigned int solution_size =
+    n_destination + n_stack * n_destination * (n_destination - 1);
+const unsigned int max_preference = 100;
+
+/**
+ * (1+1) hill climbing on the stochastic fitness (mean number of crane moves
+ * over the replications, see Racing): each mutant of the incumbent is raced
+ * against it and replaces it if it survives all the replications with a
+ * mean which is not worse.
+ */
+class HillClimbing
+{
+public:
+    HillClimbing(Racing & racing, unsigned int seed) :
+        _racing(racing), _rng(seed), _candidate_number(0),
+        _eliminated_number(0)
+    { }
+
+    // stops after time_limit seconds or max_candidate_number candidates
+    // (0: no limit)
+    void run(double time_limit, unsigned long max_candidate_number)
+    {
+        Solution candidate;
+        std::vector<int> replications;
+
+        _start = std::chrono::steady_clock::now();
+        init();
+        while (elapsed() < time_limit and
+               (max_candidate_number == 0 or
+                _candidate_number < max_candidate_number)) {
+            mutate(candidate);
+            ++_candidate_number;
+            if (not _racing.race(candidate, replications, _replications)) {
+                ++_eliminated_number;
+            } else if (candidate.fitness() <= _incumbent.fitness()) {
+                bool better = candidate.fitness() < _incumbent.fitness();
+
+                _incumbent = candidate;
+                _replications.swap(replications);
+                if (better) {
+                    report('*');
+                }
+            }
+        }
+        report(' ');
+        std::cout << "# " << _candidate_number << " candidates in "
+                  << elapsed() << " s, " << _eliminated_number
+                  << " eliminated: " << _racing.replications()
+                  << " replications, " << _racing.saved_replications()
+                  << " saved" << std::endl;
+        std::cout << _incumbent.to_string() << std::endl;
+    }
+
+private:
+    double elapsed() const
+    {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - _start).count();
+    }
+
+    // random incumbent with all its replications
+    void init()
+    {
+        std::uniform_int_distribution<unsigned int> preference(
+            0, max_preference - 1);
+
+        _incumbent.resize(solution_size);
+        for (unsigned int & x : _incumbent) {
+            x = preference(_rng);
+        }
+        _racing.evaluate(_incumbent, _replications);
+        std::cout << "# time candidates eliminated replications saved best"
+                  << std::endl;
+        report('*');
+    }
+
+    void report(char mark) const
+    {
+        std::cout << mark << " " << elapsed() << " " << _candidate_number
+                  << " " << _eliminated_number << " "
+                  << _racing.replications() << " "
+                  << _racing.saved_replications() << " "
+                  << _incumbent.fitness() << std::endl;
+    }
+
+    // one preference at least is changed
+    void mutate(Solution & candidate)
+    {
+        std::uniform_real_distribution<double> probability(0, 1);
+        std::uniform_int_distribution<unsigned int> preference(
+            0, max_preference - 1);
+        std::uniform_int_distribution<size_t> index(0, solution_size - 1);
+
+        candidate = _incumbent;
+        candidate[index(_rng)] = preference(_rng);
+        for (unsigned int & x : candidate) {
+            if (probability(_rng) < 1. / solution_size) {
+                x = preference(_rng);
+            }
+        }
+    }
+
+    Racing &                  _racing;
+    std::mt19937              _rng;
+
+    Solution                  _incumbent;
+    std::vector<int>          _replications;
+    unsigned long             _candidate_number;
+    unsigned long             _eliminated_number;
+    std::chrono::steady_clock::time_point _start;
+};
+
+} // namespace
+
+/**
+ * usage: cc-hill-climbing [seconds [threads [replications [seed
+ *                         [max candidates]]]]]
+ */
+int main(int argc, char** argv)
+{
+    double time_limit = argc > 1 ? std::atof(argv[1]) : 60;
+    unsigned int thread_number = argc > 2 ? std::atoi(argv[2]) :
+        std::thread::hardware_concurrency();
+    unsigned int replication_number = argc > 3 ? std::atoi(argv[3]) : 20;
+    unsigned int seed = argc > 4 ? std::atoi(argv[4]) : 1;
+    unsigned long max_candidate_number = argc > 5 ? std::atol(argv[5]) : 0;
+
+    EvalCC eval(5489, thread_number);
+
+    // the deadlocked replications are aborted with a penalty, the others
+    // run until the end
+    eval.cutoff(EvalCC::NO_BOUND);
+
+    Racing racing(eval, replication_number);
+    HillClimbing hill_climbing(racing, seed);
+
+    hill_climbing.run(time_limit, max_candidate_number);
+    return 0;
+}
@@ -24,6 +24,7 @@
 #include <models.hpp>
 
 #include <artis-star/common/RootCoordinator.hpp>
+#include <artis-star/common/utils/TraceBuffer.hpp>
 
 #include <solution.hpp>
 #include <evalCC.hpp>
@@ -94,8 +95,25 @@ void stat(const artis::common::RootCoordinator < DoubleTime,
 }
 */
 
-int main()
+/*
+ * The models whose paths are given on the command line (:root:CC:c for the
+ * crane, all the models if none) are traced in path.0, path.1..., see
+ * cc-trace-decode.
+ *
+ * usage: cc-simulator-main [trace path [model paths]]
+ */
+int main(int argc, char** argv)
 {
+    if (argc > 1) {
+        TraceBuffer < DoubleTime >::open(argv[1]);
+        if (argc == 2) {
+            TraceBuffer < DoubleTime >::enable();
+        }
+        for (int i = 2; i < argc; ++i) {
+            TraceBuffer < DoubleTime >::enable(argv[i]);
+        }
+    }
+
 	// constants related to the dimension of the optimization problem 
     const unsigned int n_stack = 5;
     const unsigned int n_destination = 8;
@@ -124,5 +142,6 @@ int main()
     // print the result
     //std::cout << s.to_string() << std::endl;
 
+    TraceBuffer < DoubleTime >::close();
     return 0;
 }
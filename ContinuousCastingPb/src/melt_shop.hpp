@@ -0,0 +1,184 @@
+/**
+ * @file melt_shop.hpp
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * Copyright (C) 2017-2018 ULCO http://www.univ-litoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CC_MELT_SHOP_HPP
+#define CC_MELT_SHOP_HPP
+
+#include <graph_manager.hpp>
+#include <slab_catalog.hpp>
+#include <transfer.hpp>
+#include <yard.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace cc {
+
+struct CasterLineParameters
+{
+    unsigned int cc_index;
+};
+
+// plant of a caster of the melt shop: the slabs delivered by the crane
+// are carried to the yard through the output port OUT
+class CasterLineGraphManager : public SubGraphManager
+{
+public:
+    enum submodels { TRANSFER = 30 };
+    enum outputs { OUT };
+
+    CasterLineGraphManager(Coordinator* coordinator,
+                           const GlobalParameters& parameters,
+                           const CasterLineParameters& graph_parameters) :
+        SubGraphManager(coordinator, parameters, NoParameters(),
+                        strand(graph_parameters.cc_index, 1),
+                        strand(graph_parameters.cc_index, 2)),
+        transfer("t", TransferParameters{ 10 })
+    {
+        add_child(TRANSFER, &transfer);
+        coordinator->add_out_port({ OUT, "out" });
+        for (unsigned int i = 1; i <= 5; ++i) {
+            out(crane, Crane::OUT_SLAB + i) >>
+                in(&transfer, Transfer::IN_SLAB);
+        }
+        out({ &transfer, Transfer::OUT }) >> out({ coordinator, OUT });
+    }
+
+    virtual ~CasterLineGraphManager()
+    { }
+
+private:
+    // the strands of caster 21 are the ones of the CC plant, the others
+    // are rebuilt from the catalog
+    static GeneratorParameters strand(unsigned int cc_index,
+                                      unsigned int number)
+    {
+        if (cc_index == 21) {
+            return caster_21(number);
+        }
+
+        GeneratorParameters p;
+
+        p.cc_index = cc_index;
+        p.start_indexes =
+            SlabCatalog::catalog().strands(cc_index, 2)[number - 1];
+        return p;
+    }
+
+    Simulator < Transfer, TransferParameters > transfer;
+};
+
+typedef artis::pdevs::Coordinator <
+    artis::common::DoubleTime, CasterLineGraphManager, GlobalParameters,
+    CasterLineParameters, Scheduler > CasterLine;
+
+// yard of the melt shop, the slabs of the caster lines come in IN
+class YardGraphManager : public GraphManager
+{
+public:
+    enum submodels { YARD };
+    enum inputs { IN };
+
+    YardGraphManager(Coordinator* coordinator,
+                     const GlobalParameters& parameters,
+                     const NoParameters& graph_parameters) :
+        GraphManager(coordinator, parameters, graph_parameters),
+        yard("yard", YardParameters{ 20, 30 })
+    {
+        add_child(YARD, &yard);
+        coordinator->add_in_port({ IN, "in" });
+        in({ coordinator, IN }) >> in({ &yard, Yard::IN });
+    }
+
+    virtual ~YardGraphManager()
+    { }
+
+    const Yard& get_yard() const
+    { return yard.dynamics(); }
+
+private:
+    Simulator < Yard, YardParameters > yard;
+};
+
+typedef PDEVSCoordinator < YardGraphManager > YardCoordinator;
+
+/**
+ * Caster lines of all the casters of the catalog and their yard. If Flat,
+ * the lines and the yard are flattened into the root coordinator: it is
+ * the sequential simulation of the logical processes of
+ * pdevs::timewarp::RootCoordinator, one by line and one for the yard.
+ * Otherwise they stay coupled children of the root coordinator (see
+ * pdevs::multithreading::Coordinator).
+ */
+template < bool Flat >
+class BasicMeltShopGraphManager : public GraphManager
+{
+public:
+    enum submodels { LINE, YARD };
+
+    BasicMeltShopGraphManager(Coordinator* coordinator,
+                              const GlobalParameters& parameters,
+                              const NoParameters& graph_parameters) :
+        GraphManager(coordinator, parameters, graph_parameters),
+        yard("yard", parameters, graph_parameters)
+    {
+        for (unsigned int cc_index : SlabCatalog::catalog().casters()) {
+            lines.emplace_back(new CasterLine(
+                                   (boost::format("cc_%1%") %
+                                    cc_index).str(), parameters,
+                                   CasterLineParameters{ cc_index }));
+            add_children(LINE, lines.back().get());
+        }
+        // after the lines, as the process of the yard
+        add_child(YARD, &yard);
+        for (auto & line : lines) {
+            out({ line.get(), CasterLineGraphManager::OUT }) >>
+                in({ &yard, YardGraphManager::IN });
+        }
+        if (Flat) {
+            flatten();
+        }
+    }
+
+    virtual ~BasicMeltShopGraphManager()
+    { }
+
+    unsigned int line_number() const
+    { return lines.size(); }
+
+    const CasterLineGraphManager& get_line(unsigned int index) const
+    { return lines[index]->get_graph_manager(); }
+
+    const Yard& get_yard() const
+    { return yard.get_graph_manager().get_yard(); }
+
+private:
+    std::vector < std::unique_ptr < CasterLine > > lines;
+    YardCoordinator                                yard;
+};
+
+typedef BasicMeltShopGraphManager < true > MeltShopGraphManager;
+typedef BasicMeltShopGraphManager < false > CoupledMeltShopGraphManager;
+
+} // namespace cc
+
+#endif
@@ -22,6 +22,8 @@
 
 #include <models.hpp>
 
+#include <sstream>
+
 namespace cc {
 
 std::string Slab::to_string() const
@@ -31,6 +33,26 @@ std::string Slab::to_string() const
             max_date).str();
 }
 
+std::array < double, 7 > Slab::trace_fields() const
+{
+    return { { (double)index, (double)cc_number, length, width,
+                (double)destination, (double)table_number, max_date } };
+}
+
+Slab Slab::from_trace_fields(const double* fields)
+{
+    Slab slab;
+
+    slab.index = fields[0];
+    slab.cc_number = fields[1];
+    slab.length = fields[2];
+    slab.width = fields[3];
+    slab.destination = fields[4];
+    slab.table_number = fields[5];
+    slab.max_date = fields[6];
+    return slab;
+}
+
 std::string Slabs::to_string() const
 {
     std::string str = "{ ";
@@ -43,6 +65,86 @@ std::string Slabs::to_string() const
     return str;
 }
 
+void Slabs::trace_fields(std::vector < double >& fields) const
+{
+    fields.push_back(size());
+    for (const_iterator it = begin(); it != end(); ++it) {
+        std::array < double, 7 > slab_fields = it->trace_fields();
+
+        fields.insert(fields.end(), slab_fields.begin(), slab_fields.end());
+    }
+}
+
+std::string trace_comment(unsigned int format,
+                          const std::vector < double >& fields)
+{
+    std::ostringstream ss;
+    auto field = [&fields](size_t i) { return (unsigned int)fields[i]; };
+
+    switch (format) {
+    case TRACE_IN_SLAB:
+        ss << "in -> "
+           << Slab::from_trace_fields(fields.data()).to_string();
+        break;
+    case TRACE_OUT_SLAB:
+        ss << "out: "
+           << Slab::from_trace_fields(fields.data()).to_string();
+        break;
+    case TRACE_NEW_SLAB:
+        ss << "new -> "
+           << Slab::from_trace_fields(fields.data()).to_string();
+        break;
+    case TRACE_ARRIVED_SLAB:
+        ss << "arrived -> "
+           << Slab::from_trace_fields(fields.data()).to_string();
+        break;
+    case TRACE_SELECT:
+        ss << "select -> ";
+        for (size_t i = 0; i < fields.size(); ) {
+            Slabs slabs;
+            unsigned int n = field(i++);
+
+            for (unsigned int j = 0; j < n; ++j, i += 7) {
+                slabs.push_back(Slab::from_trace_fields(&fields[i]));
+            }
+            ss << slabs.to_string() << " ";
+        }
+        break;
+    case TRACE_CLUSTER_FULL:
+        ss << "full: " << field(0) << " [ ";
+        for (size_t i = 2; i < fields.size(); ++i) {
+            ss << field(i) << " ";
+        }
+        ss << "] - " << field(1);
+        break;
+    case TRACE_CLUSTER_EMPTY: ss << "empty: " << field(0); break;
+    case TRACE_CRANE_FULL:
+        ss << "full: " << field(0) << " [ ";
+        for (size_t i = 3; i < fields.size(); ++i) {
+            ss << field(i) << " ";
+        }
+        ss << "] - " << field(1) << " " << field(2);
+        break;
+    case TRACE_CRANE_IN: ss << "in -> " << field(0) << " " << field(1); break;
+    case TRACE_CRANE_EMPTY:
+        ss << "empty -> " << field(0) << " " << field(1);
+        break;
+    case TRACE_CRANE_TAKE:
+        ss << "take: stack_" << field(0) << " " << field(1) << " slabs";
+        break;
+    case TRACE_CRANE_OUT: ss << "out: " << field(0); break;
+    case TRACE_FULL_STACK: ss << "full -> " << field(0); break;
+    case TRACE_EMPTY_STACK: ss << "empty -> " << field(0); break;
+    case TRACE_TAKE_NUMBER: ss << "take: " << field(0); break;
+    case TRACE_TAKE: ss << "take"; break;
+    case TRACE_FULL: ss << "full"; break;
+    case TRACE_EMPTY: ss << "empty"; break;
+    case TRACE_FAIL: ss << "fail"; break;
+    case TRACE_FAILED: ss << "FAILED"; break;
+    }
+    return ss.str();
+}
+
 } // namespace cc
 
 std::ostream& operator<<(std::ostream& o, const cc::Slab& slab)
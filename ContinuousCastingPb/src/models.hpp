@@ -31,6 +31,7 @@
 
 #include <utils/rand.hpp>
 
+#include <array>
 #include <ostream>
 #include <boost/format.hpp>
 
@@ -40,6 +41,7 @@ typedef artis::common::Value Value;
 typedef artis::common::Bag < artis::common::DoubleTime > Bag;
 typedef artis::common::ExternalEvent <
     artis::common::DoubleTime > ExternalEvent;
+typedef artis::common::Sink < artis::common::DoubleTime > Sink;
 
 template < class Dynamics, class Parameters = artis::common::NoParameters >
 using Context = typename artis::pdevs::Context < artis::common::DoubleTime,
@@ -55,7 +57,13 @@ static constexpr Time infinity = artis::common::DoubleTime::infinity;
 
 typedef artis::observer::View < artis::common::DoubleTime > View;
 
-static cc::utils::Rand _rand;
+// inputs of a simulation run, shared by the models and updated in place
+// between two runs of the same coupled model
+struct GlobalParameters
+{
+    std::vector < unsigned int > preferences;
+    unsigned int                 seed;
+};
 
 struct Slab
 {
@@ -68,6 +76,11 @@ struct Slab
     double max_date;
 
     std::string to_string() const;
+
+    // fields of the slab in the binary trace
+    std::array < double, 7 > trace_fields() const;
+
+    static Slab from_trace_fields(const double* fields);
 };
 
 class Slabs : public std::vector < Slab >
@@ -77,8 +90,24 @@ public:
     {}
 
     std::string to_string() const;
+
+    // number of slabs then the fields of each slab
+    void trace_fields(std::vector < double >& fields) const;
 };
 
+// formats of the comments of the binary trace of the models
+enum TraceFormat { TRACE_IN_SLAB, TRACE_OUT_SLAB, TRACE_NEW_SLAB,
+                   TRACE_ARRIVED_SLAB, TRACE_SELECT, TRACE_CLUSTER_FULL,
+                   TRACE_CLUSTER_EMPTY, TRACE_CRANE_FULL, TRACE_CRANE_IN,
+                   TRACE_CRANE_EMPTY, TRACE_CRANE_TAKE, TRACE_CRANE_OUT,
+                   TRACE_FULL_STACK, TRACE_EMPTY_STACK, TRACE_TAKE_NUMBER,
+                   TRACE_TAKE, TRACE_FULL, TRACE_EMPTY, TRACE_FAIL,
+                   TRACE_FAILED };
+
+// comment of the text trace of a binary trace record
+std::string trace_comment(unsigned int format,
+                          const std::vector < double >& fields);
+
 } // namespace cc
 
 std::ostream& operator<<(std::ostream& o, const cc::Slab& slab);
@@ -0,0 +1,172 @@
+/**
+ * @file multithreading_bench.cpp
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * Copyright (C) 2017-2018 ULCO http://www.univ-litoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <melt_shop.hpp>
+
+#include <artis-star/common/RootCoordinator.hpp>
+#include <artis-star/kernel/pdevs/multithreading/Coordinator.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace cc;
+using namespace artis::common;
+
+namespace {
+
+// constants related to the dimension of the optimization problem
+const unsigned int n_stack = 5;
+const unsigned int n_destination = 8;
+const unsigned int solution_size =
+    n_destination + n_stack * n_destination * (n_destination - 1);
+const unsigned int max_preference = 100;
+
+const DoubleTime::type t_max = 4800;
+
+// the caster lines and the yard are coupled children of the root
+typedef artis::common::RootCoordinator <
+    DoubleTime, PDEVSCoordinator < CoupledMeltShopGraphManager > >
+SequentialRoot;
+typedef artis::common::RootCoordinator <
+    DoubleTime, artis::pdevs::multithreading::Coordinator <
+        DoubleTime, CoupledMeltShopGraphManager, GlobalParameters,
+        NoParameters, Scheduler > > MultithreadingRoot;
+// the models of the lines and of the yard are children of the root
+typedef artis::common::RootCoordinator <
+    DoubleTime, PDEVSCoordinator < MeltShopGraphManager > > FlatRoot;
+
+// what is compared between the simulations
+struct Result
+{
+    std::vector < unsigned int > move_numbers;
+    unsigned int                 shipment_number;
+    unsigned int                 slab_number;
+
+    bool operator==(const Result& other) const
+    {
+        return move_numbers == other.move_numbers and
+            shipment_number == other.shipment_number and
+            slab_number == other.slab_number;
+    }
+
+    void print() const
+    {
+        std::cout << "crane moves";
+        for (unsigned int move_number : move_numbers) {
+            std::cout << " " << move_number;
+        }
+        std::cout << ", " << shipment_number << " shipments ("
+                  << slab_number << " slabs)" << std::endl;
+    }
+};
+
+double elapsed(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration < double >(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+// repetition_number runs of the melt shop, time per run in ms: result is
+// the result of the first run, false if another run differs
+template < class Root >
+bool simulate(const GlobalParameters& parameters,
+              unsigned int repetition_number, Result& result, double& time)
+{
+    Root rc(0, t_max, "root", parameters, NoParameters());
+    auto start = std::chrono::steady_clock::now();
+    bool same = true;
+
+    for (unsigned int i = 0; i < repetition_number; ++i) {
+        Result run;
+
+        rc.run();
+
+        const auto& melt_shop = rc.root().get_graph_manager();
+
+        for (unsigned int j = 0; j < melt_shop.line_number(); ++j) {
+            run.move_numbers.push_back(
+                melt_shop.get_line(j).get_crane().move_number());
+        }
+        run.shipment_number = melt_shop.get_yard().shipment_number();
+        run.slab_number = melt_shop.get_yard().slab_number();
+        if (i == 0) {
+            result = run;
+        } else if (not (run == result)) {
+            same = false;
+        }
+    }
+    time = elapsed(start) * 1e3 / repetition_number;
+    return same;
+}
+
+} // namespace
+
+/**
+ * Compares the simulations of a melt shop (a caster line by caster and a
+ * yard) by pdevs::Coordinator and by pdevs::multithreading::Coordinator,
+ * the caster lines being coupled children of the root, and by the
+ * flattened root: the moves of the cranes and the shipments of the yard
+ * must be the same in all the runs.
+ *
+ * usage: cc-multithreading-bench [repetitions [seed]]
+ */
+int main(int argc, char** argv)
+{
+    unsigned int repetition_number = argc > 1 ? std::atoi(argv[1]) : 10;
+    unsigned int seed = argc > 2 ? std::atoi(argv[2]) : 1;
+    GlobalParameters parameters;
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution < unsigned int > preference(
+        0, max_preference - 1);
+
+    repetition_number = repetition_number > 0 ? repetition_number : 1;
+    parameters.seed = 5489;
+    for (unsigned int i = 0; i < solution_size; ++i) {
+        parameters.preferences.push_back(preference(rng));
+    }
+
+    Result reference;
+    Result multithreading;
+    Result flat;
+    double time;
+    bool same = simulate < SequentialRoot >(parameters, repetition_number,
+                                            reference, time);
+
+    std::cout << "pdevs coordinator: " << time << " ms/run, ";
+    reference.print();
+    same = simulate < MultithreadingRoot >(parameters, repetition_number,
+                                           multithreading, time) and same;
+    std::cout << "multithreading coordinator: " << time << " ms/run, ";
+    multithreading.print();
+    same = simulate < FlatRoot >(parameters, repetition_number, flat,
+                                 time) and same;
+    std::cout << "flattened pdevs coordinator: " << time << " ms/run, ";
+    flat.print();
+    if (not same or not (multithreading == reference) or
+        not (flat == reference)) {
+        std::cout << "# different results" << std::endl;
+        return 1;
+    }
+    return 0;
+}
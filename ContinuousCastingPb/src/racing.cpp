@@ -0,0 +1,100 @@
+#include <racing.hpp>
+
+#include <boost/math/distributions/students_t.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+namespace cc {
+
+Racing::Racing(EvalCC & eval, unsigned int replication_number,
+               unsigned int min_replication_number, double alpha) :
+    _eval(eval), _replication_number(std::max(replication_number, 1U)),
+    _min_replication_number(std::max(min_replication_number, 2U)),
+    _alpha(alpha), _replications(0), _saved_replications(0)
+{ }
+
+void Racing::evaluate(Solution & solution, std::vector<int> & replications) {
+    check();
+    replications.clear();
+    _eval.replicate(solution, 0, _replication_number, replications);
+    _replications += _replication_number;
+    solution.fitness(mean(replications, _replication_number));
+}
+
+bool Racing::race(Solution & candidate, std::vector<int> & replications,
+                  const std::vector<int> & incumbent) {
+    check();
+    assert(incumbent.size() >= _replication_number);
+
+    // the blocks keep all the threads busy
+    unsigned int block = std::max(_eval.thread_number(), 1U);
+    unsigned int n = 0;
+
+    replications.clear();
+    while (n < _replication_number) {
+        unsigned int last = std::min(
+            std::max(n + block, _min_replication_number), _replication_number);
+
+        _eval.replicate(candidate, n, last, replications);
+        _replications += last - n;
+        n = last;
+        if (n < _replication_number and worse(replications, incumbent, n)) {
+            _saved_replications += _replication_number - n;
+            candidate.fitness(mean(replications, n));
+            replications.resize(n);
+            return false;
+        }
+    }
+    candidate.fitness(mean(replications, n));
+    return true;
+}
+
+void Racing::check() const {
+    if (_eval.bounded()) {
+        throw std::logic_error(
+            "Racing: the cutoff of the evaluator bounds the moves");
+    }
+}
+
+bool Racing::worse(const std::vector<int> & replications,
+                   const std::vector<int> & incumbent, unsigned int n) const {
+    double sum = 0;
+    double square_sum = 0;
+
+    for (unsigned int i = 0; i < n; ++i) {
+        double d = replications[i] - incumbent[i];
+
+        sum += d;
+        square_sum += d * d;
+    }
+
+    double mean = sum / n;
+    double variance = (square_sum - n * mean * mean) / (n - 1);
+
+    if (mean <= 0) {
+        return false;
+    }
+    // the same difference on each paired replication
+    if (variance <= 0) {
+        return true;
+    }
+
+    boost::math::students_t distribution(n - 1);
+    double t = mean / std::sqrt(variance / n);
+
+    return boost::math::cdf(boost::math::complement(distribution, t)) < _alpha;
+}
+
+int Racing::mean(const std::vector<int> & replications, unsigned int n) {
+    double sum = 0;
+
+    for (unsigned int i = 0; i < n; ++i) {
+        sum += replications[i];
+    }
+    return n > 0 ? (int)std::lround(sum / n) : 0;
+}
+
+} // namespace cc
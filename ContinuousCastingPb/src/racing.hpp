@@ -0,0 +1,82 @@
+#ifndef _racing_hpp
+#define _racing_hpp
+
+#include <evalCC.hpp>
+#include <solution.hpp>
+
+#include <vector>
+
+namespace cc {
+
+/**
+ * Evaluation of a solution on several replications of the stochastic
+ * simulation: the fitness is the mean number of crane moves. The
+ * replication r of every solution uses the same random streams (see
+ * EvalCC::replicate) so two solutions are compared on paired fitnesses.
+ *
+ * A candidate is raced against an incumbent: its replications are run in
+ * blocks of one replication per thread and stop as soon as a paired
+ * one-sided t-test says it is worse than the incumbent.
+ *
+ * The cutoff of the evaluator must not bound the moves (see
+ * EvalCC::bounded): the fitness of a run aborted by the bound depends on
+ * the bound and not on the solution. It may abort the deadlocks
+ * (EvalCC::NO_BOUND): the penalty is then the cost of a deadlocked
+ * replication and the mean is a penalized expected cost.
+ */
+class Racing
+{
+public:
+    /**
+     * replication_number: replications of a complete evaluation
+     * min_replication_number: replications before the first test
+     * alpha: level of the test which eliminates a candidate
+     */
+    Racing(EvalCC & eval, unsigned int replication_number,
+           unsigned int min_replication_number = 5, double alpha = 0.05);
+
+    // all the replications of the solution (std::logic_error if the moves
+    // are bounded)
+    void evaluate(Solution & /* solution */,
+                  std::vector<int> & /* replications */) ;
+
+    /**
+     * replications of candidate until it is significantly worse than the
+     * incumbent (whose replications are complete) or complete: true if
+     * candidate survived. The fitness is the mean of the replications run
+     * (std::logic_error if the moves are bounded).
+     */
+    bool race(Solution & /* candidate */, std::vector<int> & /* replications */,
+              const std::vector<int> & /* incumbent */) ;
+
+    unsigned int replication_number() const
+    { return _replication_number; }
+
+    // replications run and saved by the eliminations since the construction
+    unsigned long replications() const
+    { return _replications; }
+    unsigned long saved_replications() const
+    { return _saved_replications; }
+
+private:
+    void check() const ;
+
+    // true if the mean of the first n differences is significantly > 0
+    bool worse(const std::vector<int> & /* replications */,
+               const std::vector<int> & /* incumbent */, unsigned int /* n */)
+        const ;
+
+    static int mean(const std::vector<int> & /* replications */,
+                    unsigned int /* n */) ;
+
+    EvalCC &      _eval;
+    unsigned int  _replication_number;
+    unsigned int  _min_replication_number;
+    double        _alpha;
+    unsigned long _replications;
+    unsigned long _saved_replications;
+};
+
+} // namespace cc
+
+#endif
@@ -29,34 +29,27 @@ RunOutTable::RunOutTable(const std::string& name,
                          RunOutTableParameters >& context) :
     artis::pdevs::Dynamics < artis::common::DoubleTime, RunOutTable,
                              RunOutTableParameters >(name, context),
-    _slab(nullptr), _number(context.parameters().number)
+    _number(context.parameters().number),
+    _global(context.parameters().global)
 {
     input_ports({ { IN, "in" }, { TAKE, "take" } });
     output_ports({ { OUT, "out" }, { ARRIVED, "arrived" } });
 }
 
 RunOutTable::~RunOutTable()
-{
-    if (_slab) {
-        delete _slab;
-    }
-}
+{ }
 
 void RunOutTable::dint(Time t)
 {
     if (_phase == WAIT) {
 
-#ifdef WITH_TRACE_MODEL
-        Trace::trace() << TraceElement(get_name(), t,
-                                       artis::common::DELTA_INT)
-                       << "FAILED";
-        Trace::trace().flush();
-#endif
+        if (traced()) {
+            trace(t, artis::common::DELTA_INT, TRACE_FAILED);
+        }
 
         _phase = FAIL;
     } else if (_phase == SEND_OUT) {
-        delete _slab;
-        _slab = nullptr;
+        _slab = boost::none;
         _phase = WAIT;
     } else if (_phase == SEND_ARRIVED) {
         _phase = WAIT;
@@ -68,19 +61,17 @@ void RunOutTable::dext(Time t, Time /* e */, const Bag& msgs)
     std::for_each(msgs.begin(), msgs.end(), [this, t](const ExternalEvent &e) {
             if (e.on_port(IN)) {
                 if (_phase != FAIL) {
-                    if (_slab == nullptr) {
-                        _slab = new Slab;
+                    if (not _slab) {
+                        _slab = Slab();
                         e.data()(*_slab);
                         _slab->table_number = _number;
                         _slab->max_date = t + _rand.normal(2.5, 0.1);
                         _phase = SEND_ARRIVED;
 
-#ifdef WITH_TRACE_MODEL
-                        Trace::trace() << TraceElement(get_name(), t,
-                                                       artis::common::DELTA_EXT)
-                                       << "in -> " << _slab->to_string();
-                        Trace::trace().flush();
-#endif
+                        if (traced()) {
+                            trace(t, artis::common::DELTA_EXT, TRACE_IN_SLAB,
+                                  _slab->trace_fields());
+                        }
 
                     }
                 }
@@ -90,12 +81,9 @@ void RunOutTable::dext(Time t, Time /* e */, const Bag& msgs)
                 e.data()(table_number);
                 if (table_number == _number) {
 
-#ifdef WITH_TRACE_MODEL
-                    Trace::trace() << TraceElement(get_name(), t,
-                                                   artis::common::DELTA_EXT)
-                                   << "take";
-                    Trace::trace().flush();
-#endif
+                    if (traced()) {
+                        trace(t, artis::common::DELTA_EXT, TRACE_TAKE);
+                    }
 
                     _phase = SEND_OUT;
                 }
@@ -106,7 +94,8 @@ void RunOutTable::dext(Time t, Time /* e */, const Bag& msgs)
 Time RunOutTable::start(Time /* t */)
 {
     _phase = WAIT;
-    _slab = nullptr;
+    _slab = boost::none;
+    _rand.seed(_global->seed, _number);
     return infinity;
 }
 
@@ -125,16 +114,13 @@ Time RunOutTable::ta(Time t) const
     }
 }
 
-Bag RunOutTable::lambda(Time /* t */) const
+void RunOutTable::lambda(Time /* t */, Sink& sink) const
 {
-    Bag msgs;
-
     if (_phase == SEND_ARRIVED) {
-        msgs.push_back(ExternalEvent(ARRIVED, *_slab));
+        sink.emit(ARRIVED, *_slab);
     } else if (_phase == SEND_OUT) {
-        msgs.push_back(ExternalEvent(OUT, *_slab));
+        sink.emit(OUT, *_slab);
     }
-    return msgs;
 }
 
 } // namespace cc
@@ -25,11 +25,14 @@
 
 #include <models.hpp>
 
+#include <boost/optional.hpp>
+
 namespace cc {
 
 struct RunOutTableParameters
 {
-    unsigned int number;
+    unsigned int            number;
+    const GlobalParameters* global;
 };
 
 class RunOutTable : public artis::pdevs::Dynamics <
@@ -47,17 +50,23 @@ public:
     void dext(Time t, Time /* e */, const Bag& msgs);
     Time start(Time /* t */);
     Time ta(Time t) const;
-    Bag lambda(Time /* t */) const;
+    void lambda(Time /* t */, Sink& sink) const;
 
     Value observe(const Time& /* t */, unsigned int /* index */) const
     { return artis::common::Value(); }
 
+    // a slab has not been taken before its deadline
+    bool failed() const
+    { return _phase == FAIL; }
+
 private:
     enum Phase { WAIT, SEND_ARRIVED, SEND_OUT, FAIL };
 
-    Phase        _phase;
-    Slab*        _slab;
-    unsigned int _number;
+    Phase                   _phase;
+    boost::optional < Slab > _slab;
+    cc::utils::Rand         _rand;
+    unsigned int            _number;
+    const GlobalParameters* _global; // seed of the current run
 };
 
 } // namespace cc
@@ -0,0 +1,224 @@
+/**
+ * @file scheduler_bench.cpp
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * Copyright (C) 2017-2018 ULCO http://www.univ-litoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <graph_manager.hpp>
+#include <models.hpp>
+
+#include <artis-star/common/RootCoordinator.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace cc;
+using namespace artis::common;
+
+namespace {
+
+// constants related to the dimension of the optimization problem
+const unsigned int n_stack = 5;
+const unsigned int n_destination = 8;
+const unsigned int solution_size =
+    n_destination + n_stack * n_destination * (n_destination - 1);
+const unsigned int max_preference = 100;
+
+typedef Model < DoubleTime > model_type;
+
+// call of the event table of the plant by its coordinator
+struct Call
+{
+    enum Kind { CLEAR, INIT, PUT, TIME, MODELS };
+
+    Kind              kind;
+    DoubleTime::type  time;
+    model_type*       model;
+};
+
+typedef std::vector < Call > Calls;
+
+// scheduler which records the calls of the coordinator in trace
+template < class EventTable >
+class RecordingScheduler : public EventTable
+{
+public:
+    void clear()
+    {
+        trace->push_back({ Call::CLEAR, 0, nullptr });
+        EventTable::clear();
+    }
+
+    void init(DoubleTime::type time, model_type* model)
+    {
+        trace->push_back({ Call::INIT, time, model });
+        EventTable::init(time, model);
+    }
+
+    void put(DoubleTime::type time, const model_type* model)
+    {
+        trace->push_back({ Call::PUT, time, const_cast < model_type* >(model) });
+        EventTable::put(time, model);
+    }
+
+    DoubleTime::type get_current_time() const
+    {
+        trace->push_back({ Call::TIME, 0, nullptr });
+        return EventTable::get_current_time();
+    }
+
+    void get_current_models(DoubleTime::type time,
+                            Models < DoubleTime >& models) const
+    {
+        trace->push_back({ Call::MODELS, time, nullptr });
+        EventTable::get_current_models(time, models);
+    }
+
+    static Calls* trace;
+};
+
+template < class EventTable >
+Calls* RecordingScheduler < EventTable >::trace = nullptr;
+
+template < class EventTable >
+using Root = artis::common::RootCoordinator <
+    DoubleTime, PDEVSCoordinator < BasicRootGraphManager < EventTable >,
+                                   EventTable > >;
+
+double elapsed(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration < double >(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+// the calls on an EventTable, returns the time per call in ns
+template < class EventTable >
+double replay(const Calls& trace, unsigned int repetition_number,
+              double& checksum)
+{
+    EventTable event_table;
+    Models < DoubleTime > models;
+    auto start = std::chrono::steady_clock::now();
+
+    checksum = 0;
+    for (unsigned int i = 0; i < repetition_number; ++i) {
+        for (const Call& call : trace) {
+            switch (call.kind) {
+            case Call::CLEAR: event_table.clear(); break;
+            case Call::INIT: event_table.init(call.time, call.model); break;
+            case Call::PUT: event_table.put(call.time, call.model); break;
+            case Call::TIME: checksum += event_table.get_current_time(); break;
+            case Call::MODELS:
+                event_table.get_current_models(call.time, models);
+                // the order of the models is a part of the result
+                for (size_t j = 0; j < models.size(); ++j) {
+                    checksum += (j + 1) * (models[j]->get_child_index() + 1);
+                }
+                break;
+            }
+        }
+    }
+    return elapsed(start) * 1e9 / (trace.size() * repetition_number);
+}
+
+// complete simulations with an EventTable, returns the time per run in ms
+// (parallel_threshold: see pdevs::Coordinator::set_parallel_transitions)
+template < class EventTable >
+double simulate(const GlobalParameters& parameters,
+                unsigned int repetition_number,
+                unsigned int parallel_threshold = 0)
+{
+    Root < EventTable > rc(0, 4800, "root", parameters, NoParameters());
+
+    rc.root().set_parallel_transitions(parallel_threshold);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < repetition_number; ++i) {
+        rc.run();
+    }
+    return elapsed(start) * 1e3 / repetition_number;
+}
+
+} // namespace
+
+/**
+ * Compares the event tables of the coordinators: the calls made by the
+ * coordinator of the plant during a simulation of a random solution are
+ * replayed on each scheduler, then complete simulations are timed.
+ *
+ * usage: cc-scheduler-bench [repetitions [seed [parallel threshold]]]
+ */
+int main(int argc, char** argv)
+{
+    unsigned int repetition_number = argc > 1 ? std::atoi(argv[1]) : 100;
+    unsigned int seed = argc > 2 ? std::atoi(argv[2]) : 1;
+    unsigned int parallel_threshold = argc > 3 ? std::atoi(argv[3]) : 4;
+    GlobalParameters parameters;
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution < unsigned int > preference(
+        0, max_preference - 1);
+
+    repetition_number = repetition_number > 0 ? repetition_number : 1;
+    parameters.seed = 5489;
+    for (unsigned int i = 0; i < solution_size; ++i) {
+        parameters.preferences.push_back(preference(rng));
+    }
+
+    typedef RecordingScheduler < IndexedSchedulerType > Recorder;
+    Calls trace;
+    // the recorded models are the children of the plant of rc
+    Root < Recorder > rc(0, 4800, "root", parameters, NoParameters());
+
+    Recorder::trace = &trace;
+    rc.run();
+    Recorder::trace = nullptr;
+
+    double heap_checksum;
+    double indexed_checksum;
+    double heap = replay < SchedulerType >(trace, repetition_number,
+                                           heap_checksum);
+    double indexed = replay < IndexedSchedulerType >(trace, repetition_number,
+                                                     indexed_checksum);
+
+    std::cout << "# " << trace.size() << " calls" << std::endl;
+    std::cout << "replay fibonacci heap: " << heap << " ns/call" << std::endl;
+    std::cout << "replay indexed 4-ary heap: " << indexed << " ns/call"
+              << std::endl;
+    if (heap_checksum != indexed_checksum) {
+        std::cout << "# different results" << std::endl;
+        return 1;
+    }
+    std::cout << "simulation fibonacci heap: "
+              << simulate < SchedulerType >(parameters, repetition_number)
+              << " ms/run" << std::endl;
+    std::cout << "simulation indexed 4-ary heap: "
+              << simulate < IndexedSchedulerType >(parameters,
+                                                   repetition_number)
+              << " ms/run" << std::endl;
+    std::cout << "simulation indexed 4-ary heap, parallel transitions from "
+              << parallel_threshold << " receivers: "
+              << simulate < IndexedSchedulerType >(parameters,
+                                                   repetition_number,
+                                                   parallel_threshold)
+              << " ms/run" << std::endl;
+    return 0;
+}
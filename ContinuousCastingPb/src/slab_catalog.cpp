@@ -0,0 +1,170 @@
+/**
+ * @file slab_catalog.cpp
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * Copyright (C) 2017-2018 ULCO http://www.univ-litoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <slab_catalog.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+
+namespace cc {
+
+const SlabCatalog& SlabCatalog::catalog()
+{
+    static const SlabCatalog catalog("../data/input.csv");
+
+    return catalog;
+}
+
+SlabCatalog::SlabCatalog(const std::string& path)
+{
+    std::ifstream f(path);
+    std::vector < std::string > columns;
+    std::string line;
+
+    if (not f) {
+        throw std::runtime_error("cannot open slab file " + path);
+    }
+    while (std::getline(f, line)) {
+        boost::split(columns, line, boost::is_any_of(";"));
+
+        if (columns.size() == 10) {
+            Slab slab;
+            char destination = boost::lexical_cast < char >(columns[5]);
+
+            slab.length = boost::lexical_cast < double >(columns[7]);
+            slab.width = boost::lexical_cast < double >(columns[8]);
+            // Minus A char value (65) and adding 1 to get valid destination
+            slab.destination = destination - 64;
+            slab.index = boost::lexical_cast < int >(columns[2]);
+            slab.cc_number = boost::lexical_cast < int >(columns[0]);
+            slab.table_number = -1;
+            slab.max_date = -1;
+            _slabs[slab.cc_number].push_back(slab);
+            _timestamps[slab.cc_number].push_back(
+                boost::lexical_cast < double >(columns[1]));
+        }
+    }
+}
+
+std::vector < unsigned int > SlabCatalog::casters() const
+{
+    std::vector < unsigned int > casters;
+
+    for (auto & slabs : _slabs) {
+        casters.push_back(slabs.first);
+    }
+    return casters;
+}
+
+const Slabs& SlabCatalog::slabs(unsigned int cc_index) const
+{
+    std::map < unsigned int, Slabs >::const_iterator it =
+        _slabs.find(cc_index);
+
+    if (it == _slabs.end()) {
+        throw std::invalid_argument("unknown caster " +
+                                    std::to_string(cc_index));
+    }
+    return it->second;
+}
+
+const SlabSequence& SlabCatalog::sequence(
+    unsigned int cc_index,
+    const std::vector < unsigned int >& start_indexes) const
+{
+    std::lock_guard < std::mutex > lock(_mutex);
+    std::unique_ptr < SlabSequence >& sequence =
+        _sequences[SequenceKey(cc_index, start_indexes)];
+
+    if (sequence) {
+        return *sequence;
+    }
+
+    const Slabs& slabs = this->slabs(cc_index);
+    const std::vector < double >& timestamps =
+        _timestamps.find(cc_index)->second;
+    unsigned int index = 0;
+    unsigned int stack_index = start_indexes[index];
+    double timestamp = -1;
+
+    sequence.reset(new SlabSequence);
+    for (unsigned int i = 0; i < slabs.size(); ++i) {
+        bool ok = true;
+        unsigned int current_index = slabs[i].index;
+
+        if (stack_index == current_index) {
+            ++stack_index;
+        } else if (index < start_indexes.size() - 1 and
+                   current_index == start_indexes[index + 1]) {
+            ++index;
+            stack_index = start_indexes[index] + 1;
+        } else {
+            ok = false;
+        }
+        if (ok) {
+            double duration;
+
+            if (timestamp == -1) {
+                duration = 0;
+            } else {
+                duration = (timestamps[i] - timestamp) * 24 * 60;
+            }
+            timestamp = timestamps[i];
+            sequence->slabs.push_back(slabs[i]);
+            sequence->durations.push_back(duration);
+        }
+    }
+    return *sequence;
+}
+
+std::vector < std::vector < unsigned int > > SlabCatalog::strands(
+    unsigned int cc_index, unsigned int n) const
+{
+    const Slabs& slabs = this->slabs(cc_index);
+    const std::vector < double >& timestamps =
+        _timestamps.find(cc_index)->second;
+    std::vector < std::vector < unsigned int > > strands(n);
+    // next index and end of the current run of each strand
+    std::vector < unsigned int > next_indexes(n, 0);
+    std::vector < double > ends(n, -1);
+
+    for (unsigned int i = 0; i < slabs.size(); ++i) {
+        unsigned int index = slabs[i].index;
+        unsigned int strand = std::find(next_indexes.begin(),
+                                        next_indexes.end(), index) -
+            next_indexes.begin();
+
+        if (strand == n) {
+            strand = std::min_element(ends.begin(), ends.end()) -
+                ends.begin();
+            strands[strand].push_back(index);
+        }
+        next_indexes[strand] = index + 1;
+        ends[strand] = timestamps[i];
+    }
+    return strands;
+}
+
+} // namespace cc
@@ -0,0 +1,88 @@
+/**
+ * @file slab_catalog.hpp
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * Copyright (C) 2017-2018 ULCO http://www.univ-litoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CC_SLAB_CATALOG_HPP
+#define CC_SLAB_CATALOG_HPP
+
+#include <models.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cc {
+
+// slabs sent by a generator and the durations between two slabs
+struct SlabSequence
+{
+    Slabs                  slabs;
+    std::vector < double > durations;
+};
+
+/**
+ * Read-only catalog of the slabs of input.csv: the file is parsed once
+ * per process and the generators only keep a view on their sequence.
+ */
+class SlabCatalog
+{
+public:
+    static const SlabCatalog& catalog();
+
+    // indexes of the casters of the file
+    std::vector < unsigned int > casters() const;
+
+    // slabs of the caster in the order of the file
+    const Slabs& slabs(unsigned int cc_index) const;
+
+    // sequence of the caster following the given start indexes, built on
+    // first request and shared by all the generators using it
+    const SlabSequence& sequence(
+        unsigned int cc_index,
+        const std::vector < unsigned int >& start_indexes) const;
+
+    // start indexes of the n generators of the caster: the slabs are cast
+    // in runs of consecutive indexes and a run goes to the strand which
+    // ended its previous run first. It is an approximation: the runs of
+    // caster 21 validated against the plant are not all consecutive
+    // indexes (see SubGraphManager)
+    std::vector < std::vector < unsigned int > > strands(
+        unsigned int cc_index, unsigned int n) const;
+
+private:
+    SlabCatalog(const std::string& path);
+
+    typedef std::pair < unsigned int,
+                        std::vector < unsigned int > > SequenceKey;
+
+    std::map < unsigned int, Slabs >                  _slabs;
+    std::map < unsigned int, std::vector < double > > _timestamps;
+
+    mutable std::map < SequenceKey,
+                       std::unique_ptr < SlabSequence > > _sequences;
+    mutable std::mutex                                     _mutex;
+};
+
+} // namespace cc
+
+#endif
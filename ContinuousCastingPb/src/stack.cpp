@@ -63,12 +63,10 @@ void Stack::dext(Time t, Time /* e */, const Bag& msgs)
 
                 e.data()(slab);
 
-#ifdef WITH_TRACE_MODEL
-                Trace::trace() << TraceElement(get_name(), t,
-                                               artis::common::DELTA_EXT)
-                               << "in -> " << slab.to_string();
-                Trace::trace().flush();
-#endif
+                if (traced()) {
+                    trace(t, artis::common::DELTA_EXT, TRACE_IN_SLAB,
+                          slab.trace_fields());
+                }
 
                 _slabs.push_back(slab);
                 _state = _slabs.size() >= 5 ? FULL : NO_FULL;
@@ -78,22 +76,17 @@ void Stack::dext(Time t, Time /* e */, const Bag& msgs)
             } else if (e.on_port(TAKE)) {
                 e.data()(_taken_slab_number);
 
-#ifdef WITH_TRACE_MODEL
-                Trace::trace() << TraceElement(get_name(), t,
-                                               artis::common::DELTA_EXT)
-                               << "take: " << _taken_slab_number;
-                Trace::trace().flush();
-#endif
+                if (traced()) {
+                    trace(t, artis::common::DELTA_EXT, TRACE_TAKE_NUMBER,
+                          { (double)_taken_slab_number });
+                }
 
                 _phase = SEND_DELIVER;
             } else if (e.on_port(FAIL)) {
 
-#ifdef WITH_TRACE_MODEL
-                Trace::trace() << TraceElement(get_name(), t,
-                                               artis::common::DELTA_EXT)
-                               << "fail";
-                Trace::trace().flush();
-#endif
+                if (traced()) {
+                    trace(t, artis::common::DELTA_EXT, TRACE_FAIL);
+                }
 
                 if (_state != FULL) {
                     _phase = SEND_FULL;
@@ -106,6 +99,8 @@ Time Stack::start(Time /* t */)
 {
     _phase = WAIT;
     _state = NO_FULL;
+    _slabs.clear();
+    _taken_slab_number = 0;
     return infinity;
 }
 
@@ -118,10 +113,8 @@ Time Stack::ta(Time /* t */) const
     }
 }
 
-Bag Stack::lambda(Time t) const
+void Stack::lambda(Time t, Sink& sink) const
 {
-    Bag msgs;
-
     if (_phase == SEND_FULL) {
         FullData data;
         unsigned int i = 0;
@@ -136,33 +129,26 @@ Bag Stack::lambda(Time t) const
             data.destination[j] = 0;
         }
 
-#ifdef WITH_TRACE_MODEL
-        Trace::trace() << TraceElement(get_name(), t,
-                                       artis::common::LAMBDA)
-                       << "full";
-        Trace::trace().flush();
-#endif
+        if (traced()) {
+            trace(t, artis::common::LAMBDA, TRACE_FULL);
+        }
 
-        msgs.push_back(ExternalEvent(OUT_FULL, data));
+        sink.emit(OUT_FULL, data);
     } else if (_phase == SEND_DELIVER) {
         for (unsigned int i = 0; i < _taken_slab_number; ++i) {
-            msgs.push_back(ExternalEvent(OUT, _slabs[_slabs.size() - i - 1]));
+            sink.emit(OUT, _slabs[_slabs.size() - i - 1]);
         }
     } else if (_phase == SEND_EMPTY) {
         FullData data;
 
         data.stack_index = _number;
 
-#ifdef WITH_TRACE_MODEL
-        Trace::trace() << TraceElement(get_name(), t,
-                                       artis::common::LAMBDA)
-                       << "empty";
-        Trace::trace().flush();
-#endif
+        if (traced()) {
+            trace(t, artis::common::LAMBDA, TRACE_EMPTY);
+        }
 
-        msgs.push_back(ExternalEvent(EMPTY, data));
+        sink.emit(EMPTY, data);
     }
-    return msgs;
 }
 
 Value Stack::observe(const Time& /* t */, unsigned int index) const
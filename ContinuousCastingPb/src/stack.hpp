@@ -56,7 +56,7 @@ public:
     void dext(Time /* t */, Time /* e */, const Bag& /* msgs */);
     Time start(Time t);
     Time ta(Time t) const;
-    Bag lambda(Time /* t */) const;
+    void lambda(Time /* t */, Sink& sink) const;
     Value observe(const Time& t, unsigned int index) const;
 
 private:
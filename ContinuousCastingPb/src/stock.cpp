@@ -24,12 +24,14 @@
 
 namespace cc {
 
+constexpr artis::common::InPort < Slab > Stock::IN_SLAB;
+
 Stock::Stock(const std::string& name,
              const Context < Stock, StockParameters >& context) :
     artis::pdevs::Dynamics < artis::common::DoubleTime,
                              Stock, StockParameters >(name, context)
 {
-    input_port({ IN, "in" });
+    input_port(IN_SLAB, "in");
 }
 
 Stock::~Stock()
@@ -39,29 +41,23 @@ void Stock::dint(Time /* t */)
 {
 }
 
-void Stock::dext(Time t, Time /* e */, const Bag& msgs)
+void Stock::dext(Time t, Time /* e */, const Bag& /* msgs */)
 {
-    std::for_each(msgs.begin(), msgs.end(), [this, t](const ExternalEvent &e) {
-            if (e.on_port(IN)) {
-                Slab slab;
-
-                e.data()(slab);
+    for (const Slab& slab : get_inputs(IN_SLAB)) {
 
-#ifdef WITH_TRACE_MODEL
-                Trace::trace() << TraceElement(get_name(), t,
-                                               artis::common::DELTA_EXT)
-                               << "in -> " << slab.to_string();
-                Trace::trace().flush();
-#endif
+        if (traced()) {
+            trace(t, artis::common::DELTA_EXT, TRACE_IN_SLAB,
+                  slab.trace_fields());
+        }
 
-                _slabs.push_back(slab);
-            }
-        });
+        _slabs.push_back(slab);
+    }
 }
 
 Time Stock::start(Time /* t */)
 {
     _phase = WAIT;
+    _slabs.clear();
     return infinity;
 }
 
@@ -70,11 +66,4 @@ Time Stock::ta(Time /* t */) const
     return infinity;
 }
 
-Bag Stock::lambda(Time /* t */) const
-{
-    Bag msgs;
-
-    return msgs;
-}
-
 } // namespace cc
@@ -37,6 +37,8 @@ class Stock : public artis::pdevs::Dynamics <
 public:
     enum inputs { IN };
 
+    static constexpr artis::common::InPort < Slab > IN_SLAB = { IN };
+
     Stock(const std::string& name,
           const Context < Stock, StockParameters >& context);
     virtual ~Stock();
@@ -45,7 +47,6 @@ public:
     void dext(Time /* t */, Time /* e */, const Bag& /* msgs */);
     Time start(Time t);
     Time ta(Time t) const;
-    Bag lambda(Time /* t */) const;
 
     Value observe(const Time& /* t */, unsigned int /* index */) const
     { return artis::common::Value(); }
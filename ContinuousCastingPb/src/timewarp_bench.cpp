@@ -0,0 +1,447 @@
+/**
+ * @file timewarp_bench.cpp
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * Copyright (C) 2017-2018 ULCO http://www.univ-litoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <melt_shop.hpp>
+
+#include <artis-star/common/RootCoordinator.hpp>
+#include <artis-star/kernel/pdevs/timewarp/RootCoordinator.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace cc {
+
+struct RelayParameters
+{
+    unsigned int index;
+};
+
+/**
+ * Passes tokens around a ring of processes: a token received at t leaves
+ * with the next value after a delay that depends on the value, zero for
+ * one token out of three. Some tokens go back to their own process
+ * through LOOP, the others go to the next process through OUT.
+ */
+class Relay : public artis::pdevs::Dynamics <
+    artis::common::DoubleTime, Relay, RelayParameters >
+{
+public:
+    enum inputs { IN };
+    enum outputs { OUT, LOOP };
+
+    Relay(const std::string& name,
+          const Context < Relay, RelayParameters >& context) :
+        artis::pdevs::Dynamics < artis::common::DoubleTime, Relay,
+                                 RelayParameters >(name, context),
+        _index(context.parameters().index)
+    {
+        input_ports({ { IN, "in" } });
+        output_ports({ { OUT, "out" }, { LOOP, "loop" } });
+    }
+
+    void dint(Time t)
+    {
+        _tokens.erase(t);
+    }
+
+    void dext(Time t, Time /* e */, const Bag& msgs)
+    {
+        for (const ExternalEvent& event : msgs) {
+            unsigned int token;
+
+            event.data()(token);
+            ++_received_number;
+            // independent of the order of the bag
+            _checksum += (unsigned long)token * (unsigned long)(t + 1);
+            _tokens.insert(std::make_pair(t + delay(token + 1), token + 1));
+        }
+    }
+
+    void dconf(Time t, Time /* e */, const Bag& msgs)
+    {
+        dint(t);
+        dext(t, 0, msgs);
+    }
+
+    Time start(Time /* t */)
+    {
+        _tokens.clear();
+        _tokens.insert(std::make_pair(_index % 3, 1000 * _index + 1));
+        _received_number = 0;
+        _checksum = 0;
+        return _tokens.begin()->first;
+    }
+
+    Time ta(Time t) const
+    {
+        return _tokens.empty() ? infinity : _tokens.begin()->first - t;
+    }
+
+    void lambda(Time /* t */, Sink& sink) const
+    {
+        Time departure = _tokens.begin()->first;
+
+        for (auto it = _tokens.begin(); it != _tokens.end() and
+                 it->first == departure; ++it) {
+            sink.emit(it->second % 4 == 1 ? LOOP : OUT, it->second);
+        }
+    }
+
+    unsigned int received_number() const
+    { return _received_number; }
+
+    unsigned long checksum() const
+    { return _checksum; }
+
+private:
+    Time delay(unsigned int token) const
+    { return token % 3 == 0 ? 0 : 1 + (token * 7 + _index) % 5; }
+
+    // state: the tokens by departure time
+    std::multimap < Time, unsigned int > _tokens;
+    unsigned int                         _received_number;
+    unsigned long                        _checksum;
+
+    unsigned int                         _index;
+};
+
+// process of the ring, a relay
+class RelayGraphManager : public GraphManager
+{
+public:
+    enum submodels { RELAY };
+    enum inputs { IN };
+    enum outputs { OUT, LOOP };
+
+    RelayGraphManager(Coordinator* coordinator,
+                      const GlobalParameters& parameters,
+                      const RelayParameters& graph_parameters) :
+        GraphManager(coordinator, parameters, NoParameters()),
+        relay("relay", graph_parameters)
+    {
+        add_child(RELAY, &relay);
+        coordinator->add_in_port({ IN, "in" });
+        coordinator->add_out_port({ OUT, "out" });
+        coordinator->add_out_port({ LOOP, "loop" });
+        in({ coordinator, IN }) >> in({ &relay, Relay::IN });
+        out({ &relay, Relay::OUT }) >> out({ coordinator, OUT });
+        out({ &relay, Relay::LOOP }) >> out({ coordinator, LOOP });
+    }
+
+    virtual ~RelayGraphManager()
+    { }
+
+    const Relay& get_relay() const
+    { return relay.dynamics(); }
+
+private:
+    Simulator < Relay, RelayParameters > relay;
+};
+
+typedef artis::pdevs::Coordinator <
+    artis::common::DoubleTime, RelayGraphManager, GlobalParameters,
+    RelayParameters, Scheduler > RelayCoordinator;
+
+const unsigned int ring_size = 6;
+
+// the relays of the ring flattened into the root coordinator
+class RingGraphManager : public GraphManager
+{
+public:
+    enum submodels { RELAY };
+
+    RingGraphManager(Coordinator* coordinator,
+                     const GlobalParameters& parameters,
+                     const NoParameters& graph_parameters) :
+        GraphManager(coordinator, parameters, graph_parameters)
+    {
+        for (unsigned int i = 0; i < ring_size; ++i) {
+            relays.emplace_back(new RelayCoordinator(
+                                    (boost::format("relay_%1%") % i).str(),
+                                    parameters, RelayParameters{ i }));
+            add_children(RELAY, relays.back().get());
+        }
+        for (unsigned int i = 0; i < ring_size; ++i) {
+            out({ relays[i].get(), RelayGraphManager::OUT }) >>
+                in({ relays[(i + 1) % ring_size].get(),
+                            RelayGraphManager::IN });
+            out({ relays[i].get(), RelayGraphManager::LOOP }) >>
+                in({ relays[i].get(), RelayGraphManager::IN });
+        }
+        flatten();
+    }
+
+    virtual ~RingGraphManager()
+    { }
+
+    const Relay& get_relay(unsigned int index) const
+    { return relays[index]->get_graph_manager().get_relay(); }
+
+private:
+    std::vector < std::unique_ptr < RelayCoordinator > > relays;
+};
+
+} // namespace cc
+
+using namespace cc;
+using namespace artis::common;
+
+namespace {
+
+// constants related to the dimension of the optimization problem
+const unsigned int n_stack = 5;
+const unsigned int n_destination = 8;
+const unsigned int solution_size =
+    n_destination + n_stack * n_destination * (n_destination - 1);
+const unsigned int max_preference = 100;
+
+const DoubleTime::type t_max = 4800;
+
+typedef artis::common::RootCoordinator <
+    DoubleTime, PDEVSCoordinator < MeltShopGraphManager > > Root;
+typedef artis::common::RootCoordinator <
+    DoubleTime, PDEVSCoordinator < RingGraphManager > > RingRoot;
+
+// what is compared between the simulations
+struct Result
+{
+    std::vector < unsigned int > move_numbers;
+    unsigned int                 shipment_number;
+    unsigned int                 slab_number;
+
+    bool operator==(const Result& other) const
+    {
+        return move_numbers == other.move_numbers and
+            shipment_number == other.shipment_number and
+            slab_number == other.slab_number;
+    }
+
+    void print() const
+    {
+        std::cout << "crane moves";
+        for (unsigned int move_number : move_numbers) {
+            std::cout << " " << move_number;
+        }
+        std::cout << ", " << shipment_number << " shipments ("
+                  << slab_number << " slabs)" << std::endl;
+    }
+};
+
+double elapsed(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration < double >(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+// sequential simulation of the flattened melt shop, time in ms
+double simulate(const GlobalParameters& parameters, Result& result)
+{
+    Root rc(0, t_max, "root", parameters, NoParameters());
+    auto start = std::chrono::steady_clock::now();
+
+    rc.run();
+
+    double time = elapsed(start) * 1e3;
+    const MeltShopGraphManager& melt_shop = rc.root().get_graph_manager();
+
+    for (unsigned int i = 0; i < melt_shop.line_number(); ++i) {
+        result.move_numbers.push_back(
+            melt_shop.get_line(i).get_crane().move_number());
+    }
+    result.shipment_number = melt_shop.get_yard().shipment_number();
+    result.slab_number = melt_shop.get_yard().slab_number();
+    return time;
+}
+
+// a logical process by caster line and one for the yard, time in ms
+double simulate(const GlobalParameters& parameters,
+                unsigned int thread_number, unsigned int state_interval,
+                unsigned int gvt_interval, Result& result,
+                artis::pdevs::timewarp::Statistics& statistics)
+{
+    std::vector < std::unique_ptr < CasterLine > > lines;
+    YardCoordinator yard("yard", parameters, NoParameters());
+    artis::pdevs::timewarp::RootCoordinator < DoubleTime > rc(0, t_max);
+
+    for (unsigned int cc_index : SlabCatalog::catalog().casters()) {
+        lines.emplace_back(new CasterLine(
+                               (boost::format("cc_%1%") % cc_index).str(),
+                               parameters, CasterLineParameters{ cc_index }));
+        rc.add_process(lines.back().get());
+    }
+
+    unsigned int yard_index = rc.add_process(&yard);
+
+    for (unsigned int i = 0; i < lines.size(); ++i) {
+        rc.add_link(i, CasterLineGraphManager::OUT, yard_index,
+                    YardGraphManager::IN);
+    }
+    rc.set_state_interval(state_interval);
+    rc.set_gvt_interval(gvt_interval);
+
+    auto start = std::chrono::steady_clock::now();
+
+    rc.run(thread_number);
+
+    double time = elapsed(start) * 1e3;
+
+    for (auto & line : lines) {
+        result.move_numbers.push_back(
+            line->get_graph_manager().get_crane().move_number());
+    }
+    result.shipment_number = yard.get_graph_manager().get_yard().
+        shipment_number();
+    result.slab_number = yard.get_graph_manager().get_yard().slab_number();
+    statistics = rc.statistics();
+    return time;
+}
+
+// tokens received by each relay and their checksums
+typedef std::vector < std::pair < unsigned int, unsigned long > > RingResult;
+
+void simulate_ring(const GlobalParameters& parameters, RingResult& result)
+{
+    RingRoot rc(0, t_max, "root", parameters, NoParameters());
+
+    rc.run();
+    for (unsigned int i = 0; i < ring_size; ++i) {
+        const Relay& relay = rc.root().get_graph_manager().get_relay(i);
+
+        result.push_back(std::make_pair(relay.received_number(),
+                                        relay.checksum()));
+    }
+}
+
+// a logical process by relay, linked to the next one and to itself
+void simulate_ring(const GlobalParameters& parameters,
+                   unsigned int thread_number, unsigned int state_interval,
+                   unsigned int gvt_interval, RingResult& result,
+                   artis::pdevs::timewarp::Statistics& statistics)
+{
+    std::vector < std::unique_ptr < RelayCoordinator > > relays;
+    artis::pdevs::timewarp::RootCoordinator < DoubleTime > rc(0, t_max);
+
+    for (unsigned int i = 0; i < ring_size; ++i) {
+        relays.emplace_back(new RelayCoordinator(
+                                (boost::format("relay_%1%") % i).str(),
+                                parameters, RelayParameters{ i }));
+        rc.add_process(relays.back().get());
+    }
+    for (unsigned int i = 0; i < ring_size; ++i) {
+        rc.add_link(i, RelayGraphManager::OUT, (i + 1) % ring_size,
+                    RelayGraphManager::IN);
+        rc.add_link(i, RelayGraphManager::LOOP, i, RelayGraphManager::IN);
+    }
+    rc.set_state_interval(state_interval);
+    rc.set_gvt_interval(gvt_interval);
+    rc.run(thread_number);
+    for (auto & relay : relays) {
+        const Relay& dynamics = relay->get_graph_manager().get_relay();
+
+        result.push_back(std::make_pair(dynamics.received_number(),
+                                        dynamics.checksum()));
+    }
+    statistics = rc.statistics();
+}
+
+void print(const std::string& name,
+           const artis::pdevs::timewarp::Statistics& statistics)
+{
+    std::cout << name << statistics.step_number << " steps for "
+              << statistics.committed_step_number << ", "
+              << statistics.rollback_number << " rollbacks, "
+              << statistics.anti_message_number << " anti-messages, "
+              << statistics.gvt_number << " GVT" << std::endl;
+}
+
+} // namespace
+
+/**
+ * Compares the sequential simulation of a melt shop (a caster line by
+ * caster and a yard) with its Time Warp simulation on 1 to n threads: the
+ * moves of the cranes and the shipments of the yard must be the same.
+ * The melt shop has no feedback, the same comparison is made on a ring of
+ * relays exchanging tokens with their neighbours and with themselves,
+ * also in zero time: its rollbacks cancel messages by anti-messages.
+ *
+ * usage: cc-timewarp-bench [threads [state interval [gvt interval]]]
+ */
+int main(int argc, char** argv)
+{
+    unsigned int thread_number = argc > 1 ? std::atoi(argv[1]) :
+        std::thread::hardware_concurrency();
+    unsigned int state_interval = argc > 2 ? std::atoi(argv[2]) : 16;
+    unsigned int gvt_interval = argc > 3 ? std::atoi(argv[3]) : 1024;
+    GlobalParameters parameters;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution < unsigned int > preference(
+        0, max_preference - 1);
+
+    thread_number = thread_number > 0 ? thread_number : 1;
+    parameters.seed = 5489;
+    for (unsigned int i = 0; i < solution_size; ++i) {
+        parameters.preferences.push_back(preference(rng));
+    }
+
+    Result reference;
+
+    std::cout << "sequential: " << simulate(parameters, reference) << " ms, ";
+    reference.print();
+    for (unsigned int n = 1; n <= thread_number; ++n) {
+        Result result;
+        artis::pdevs::timewarp::Statistics statistics;
+        double time = simulate(parameters, n, state_interval, gvt_interval,
+                               result, statistics);
+
+        std::cout << "time warp on " << n << " threads: " << time << " ms, ";
+        print("", statistics);
+        if (not (result == reference)) {
+            std::cout << "# different results: ";
+            result.print();
+            return 1;
+        }
+    }
+
+    RingResult ring_reference;
+
+    simulate_ring(parameters, ring_reference);
+    for (unsigned int n = 1; n <= thread_number; ++n) {
+        RingResult result;
+        artis::pdevs::timewarp::Statistics statistics;
+
+        simulate_ring(parameters, n, state_interval, gvt_interval, result,
+                      statistics);
+        print((boost::format("ring on %1% threads: ") % n).str(),
+              statistics);
+        if (result != ring_reference) {
+            std::cout << "# different results on the ring" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file trace_decode.cpp
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * Copyright (C) 2017-2018 ULCO http://www.univ-litoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <models.hpp>
+
+#include <artis-star/common/utils/TraceBuffer.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cc;
+using namespace artis::common;
+
+namespace {
+
+typedef TraceRecord < DoubleTime > Record;
+typedef artis::common::TraceElement < DoubleTime > Element;
+typedef TraceElements < DoubleTime > Elements;
+
+// text of a record and its time
+struct Entry
+{
+    DoubleTime::type time;
+    std::string      text;
+};
+
+typedef std::vector < Entry > Entries;
+
+class Decoder
+{
+public:
+    Decoder(const std::vector < std::string >& paths) : _paths(paths)
+    { _record.format = Record::CONTINUATION; }
+
+    // the records of a thread, in the order of their writing
+    bool decode(const std::string& path, Entries& entries)
+    {
+        FILE* file = std::fopen(path.c_str(), "rb");
+        Record record;
+
+        if (not file) {
+            return false;
+        }
+        while (std::fread(&record, sizeof(Record), 1, file) == 1) {
+            if (record.format != Record::CONTINUATION) {
+                add(entries);
+                _record = record;
+                _fields.clear();
+            }
+            _fields.insert(_fields.end(), record.fields,
+                           record.fields + record.field_number);
+        }
+        add(entries);
+        std::fclose(file);
+        return true;
+    }
+
+private:
+    void add(Entries& entries)
+    {
+        if (_record.format == Record::CONTINUATION) {
+            return;
+        }
+
+        Elements elements;
+        Element element(_record.model < _paths.size() ?
+                        _paths[_record.model] : std::string("?"),
+                        _record.time, (TraceType)_record.type);
+
+        element.set_comment(trace_comment(_record.format, _fields));
+        elements.push_back(element);
+        entries.push_back({ _record.time, elements.to_string() });
+        _record.format = Record::CONTINUATION;
+        _fields.clear();
+    }
+
+    const std::vector < std::string >& _paths;
+    Record                             _record;
+    std::vector < double >             _fields;
+};
+
+// the records of the threads by time: a run whose steps are spread over
+// several threads is printed in the order of its steps, the records of a
+// thread keep their order
+void merge(const std::vector < Entries >& threads)
+{
+    std::vector < size_t > next(threads.size(), 0);
+
+    for (;;) {
+        size_t first = threads.size();
+
+        for (size_t i = 0; i < threads.size(); ++i) {
+            if (next[i] < threads[i].size() and
+                (first == threads.size() or
+                 threads[i][next[i]].time <
+                 threads[first][next[first]].time)) {
+                first = i;
+            }
+        }
+        if (first == threads.size()) {
+            return;
+        }
+        std::cout << threads[first][next[first]++].text;
+    }
+}
+
+} // namespace
+
+/*
+ * Prints the binary trace written in path.0, path.1... in the text format
+ * of the trace of the models, the records of all the threads merged by
+ * time or only the given thread.
+ *
+ * usage: cc-trace-decode path [thread]
+ */
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " path [thread]" << std::endl;
+        return 1;
+    }
+
+    std::string path = argv[1];
+    std::ifstream paths_file(path + ".names");
+    std::vector < std::string > paths;
+    std::string model_path;
+
+    if (not paths_file) {
+        std::cerr << "no model paths in " << path << ".names" << std::endl;
+        return 1;
+    }
+    while (std::getline(paths_file, model_path)) {
+        paths.push_back(model_path);
+    }
+
+    Decoder decoder(paths);
+    std::vector < Entries > threads(1);
+
+    if (argc > 2) {
+        if (not decoder.decode(path + "." + argv[2], threads.back())) {
+            return 1;
+        }
+    } else {
+        while (decoder.decode(path + "." +
+                              std::to_string(threads.size() - 1),
+                              threads.back())) {
+            threads.push_back(Entries());
+        }
+    }
+    merge(threads);
+    return 0;
+}
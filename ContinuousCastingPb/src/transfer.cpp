@@ -0,0 +1,96 @@
+/**
+ * @file transfer.cpp
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * Copyright (C) 2017-2018 ULCO http://www.univ-litoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <transfer.hpp>
+
+namespace cc {
+
+constexpr artis::common::InPort < Slab > Transfer::IN_SLAB;
+
+Transfer::Transfer(const std::string& name,
+                   const Context < Transfer, TransferParameters >& context) :
+    artis::pdevs::Dynamics < artis::common::DoubleTime,
+                             Transfer, TransferParameters >(name, context),
+    _duration(context.parameters().duration)
+{
+    input_port(IN_SLAB, "in");
+    output_port({ OUT, "out" });
+}
+
+Transfer::~Transfer()
+{ }
+
+void Transfer::dint(Time /* t */)
+{
+    Time arrival = _slabs.front().first;
+
+    while (not _slabs.empty() and _slabs.front().first == arrival) {
+        _slabs.pop_front();
+    }
+}
+
+void Transfer::dext(Time t, Time /* e */, const Bag& /* msgs */)
+{
+    for (const Slab& slab : get_inputs(IN_SLAB)) {
+
+        if (traced()) {
+            trace(t, artis::common::DELTA_EXT, TRACE_IN_SLAB,
+                  slab.trace_fields());
+        }
+
+        _slabs.push_back(std::make_pair(t + _duration, slab));
+    }
+}
+
+void Transfer::dconf(Time t, Time /* e */, const Bag& msgs)
+{
+    dint(t);
+    dext(t, 0, msgs);
+}
+
+Time Transfer::start(Time /* t */)
+{
+    _slabs.clear();
+    return infinity;
+}
+
+Time Transfer::ta(Time t) const
+{
+    return _slabs.empty() ? infinity : _slabs.front().first - t;
+}
+
+void Transfer::lambda(Time t, Sink& sink) const
+{
+    // the slabs delivered at the same time arrive together
+    for (auto it = _slabs.begin(); it != _slabs.end() and
+             it->first == _slabs.front().first; ++it) {
+
+        if (traced()) {
+            trace(t, artis::common::LAMBDA, TRACE_OUT_SLAB,
+                  it->second.trace_fields());
+        }
+
+        sink.emit(OUT, it->second);
+    }
+}
+
+} // namespace cc
@@ -0,0 +1,73 @@
+/**
+ * @file transfer.hpp
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * Copyright (C) 2017-2018 ULCO http://www.univ-litoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CC_TRANSFER_HPP
+#define CC_TRANSFER_HPP
+
+#include <models.hpp>
+
+#include <deque>
+#include <utility>
+
+namespace cc {
+
+struct TransferParameters
+{
+    double duration;
+};
+
+// carries the slabs delivered by the crane out of the caster line, each
+// one arrives duration after its delivery
+class Transfer : public artis::pdevs::Dynamics <
+    artis::common::DoubleTime, Transfer, TransferParameters >
+{
+public:
+    enum inputs { IN };
+    enum outputs { OUT };
+
+    static constexpr artis::common::InPort < Slab > IN_SLAB = { IN };
+
+    Transfer(const std::string& name,
+             const Context < Transfer, TransferParameters >& context);
+    virtual ~Transfer();
+
+    void dint(Time /* t */);
+    void dext(Time t, Time /* e */, const Bag& /* msgs */);
+    void dconf(Time t, Time /* e */, const Bag& msgs);
+    Time start(Time /* t */);
+    Time ta(Time t) const;
+    void lambda(Time t, Sink& sink) const;
+
+    Value observe(const Time& /* t */, unsigned int /* index */) const
+    { return artis::common::Value(); }
+
+private:
+    // state: the slabs on the way and their arrival times
+    std::deque < std::pair < Time, Slab > > _slabs;
+
+    // parameters
+    double                                  _duration;
+};
+
+} // namespace cc
+
+#endif
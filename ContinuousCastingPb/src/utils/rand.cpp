@@ -45,6 +45,14 @@ Rand::seed(result_type seed)
     m_rand.seed(seed);
 }
 
+void
+Rand::seed(result_type seed, result_type stream)
+{
+    std::seed_seq sequence = { seed, stream };
+
+    m_rand.seed(sequence);
+}
+
 bool
 Rand::getBool()
 {
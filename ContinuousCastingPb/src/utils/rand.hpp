@@ -51,6 +51,15 @@ public:
      */
     void seed(result_type seed);
 
+    /**
+     * @brief Set the seed for the random number generator from a base seed
+     * and a stream number, so that models sharing the same base seed draw
+     * from independent sequences.
+     * @param seed the base seed of the simulation run.
+     * @param stream the index of the stream (one per random model).
+     */
+    void seed(result_type seed, result_type stream);
+
     /**
      * @brief Generate a boolean value [true, false] using the Bernoulli
      * distribition where p = 0.5. (P(true) = p, P(false) = 1 - p).
@@ -0,0 +1,118 @@
+/**
+ * @file yard.cpp
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * Copyright (C) 2017-2018 ULCO http://www.univ-litoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <yard.hpp>
+
+namespace cc {
+
+Yard::Yard(const std::string& name,
+           const Context < Yard, YardParameters >& context) :
+    artis::pdevs::Dynamics < artis::common::DoubleTime,
+                             Yard, YardParameters >(name, context),
+    _lot_size(context.parameters().lot_size),
+    _loading_duration(context.parameters().loading_duration)
+{
+    input_port({ IN, "in" });
+    observables({ { SHIPMENT_NUMBER, "shipment_number" },
+            { SLAB_NUMBER, "slab_number" } });
+}
+
+Yard::~Yard()
+{ }
+
+void Yard::dint(Time /* t */)
+{
+    if (_phase == LOAD) {
+        ++_shipment_number;
+        _slab_number += _full_lots.front().size();
+        _full_lots.pop_front();
+        if (_full_lots.empty()) {
+            _phase = WAIT;
+            _sigma = infinity;
+        } else {
+            _sigma = _loading_duration;
+        }
+    }
+}
+
+void Yard::dext(Time t, Time e, const Bag& msgs)
+{
+    for (const ExternalEvent& event : msgs) {
+        if (event.on_port(IN)) {
+            Slab slab;
+
+            event.data()(slab);
+
+            if (traced()) {
+                trace(t, artis::common::DELTA_EXT, TRACE_IN_SLAB,
+                      slab.trace_fields());
+            }
+
+            Slabs& lot = _lots[slab.destination];
+
+            lot.push_back(slab);
+            if (lot.size() == _lot_size) {
+                _full_lots.push_back(lot);
+                lot.clear();
+            }
+        }
+    }
+    if (_phase == LOAD) {
+        _sigma -= e;
+    } else if (not _full_lots.empty()) {
+        _phase = LOAD;
+        _sigma = _loading_duration;
+    }
+}
+
+void Yard::dconf(Time t, Time /* e */, const Bag& msgs)
+{
+    dint(t);
+    dext(t, 0, msgs);
+}
+
+Time Yard::start(Time /* t */)
+{
+    _phase = WAIT;
+    _lots.clear();
+    _full_lots.clear();
+    _sigma = infinity;
+    _shipment_number = 0;
+    _slab_number = 0;
+    return infinity;
+}
+
+Time Yard::ta(Time /* t */) const
+{
+    return _sigma;
+}
+
+Value Yard::observe(const Time& /* t */, unsigned int index) const
+{
+    switch (index) {
+    case SHIPMENT_NUMBER: return (int)_shipment_number;
+    case SLAB_NUMBER: return (int)_slab_number;
+    }
+    return Value();
+}
+
+} // namespace cc
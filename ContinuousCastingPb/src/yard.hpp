@@ -0,0 +1,88 @@
+/**
+ * @file yard.hpp
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * Copyright (C) 2017-2018 ULCO http://www.univ-litoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CC_YARD_HPP
+#define CC_YARD_HPP
+
+#include <models.hpp>
+
+#include <deque>
+#include <map>
+
+namespace cc {
+
+struct YardParameters
+{
+    unsigned int lot_size;
+    double       loading_duration;
+};
+
+// receives the slabs of the caster lines and ships them by lots of the
+// same destination, one lot at a time
+class Yard : public artis::pdevs::Dynamics <
+    artis::common::DoubleTime, Yard, YardParameters >
+{
+public:
+    enum inputs { IN };
+    enum vars { SHIPMENT_NUMBER, SLAB_NUMBER };
+
+    Yard(const std::string& name,
+         const Context < Yard, YardParameters >& context);
+    virtual ~Yard();
+
+    void dint(Time /* t */);
+    void dext(Time t, Time e, const Bag& msgs);
+    void dconf(Time t, Time /* e */, const Bag& msgs);
+    Time start(Time /* t */);
+    Time ta(Time /* t */) const;
+
+    Value observe(const Time& /* t */, unsigned int index) const;
+
+    unsigned int shipment_number() const
+    { return _shipment_number; }
+
+    // shipped slabs
+    unsigned int slab_number() const
+    { return _slab_number; }
+
+private:
+    enum Phase { WAIT, LOAD };
+
+    // state
+    Phase                            _phase;
+    // lots in progress by destination
+    std::map < unsigned int, Slabs > _lots;
+    std::deque < Slabs >             _full_lots;
+    Time                             _sigma;
+
+    // parameters
+    unsigned int                     _lot_size;
+    double                           _loading_duration;
+
+    // observables
+    unsigned int                     _shipment_number;
+    unsigned int                     _slab_number;
+};
+
+} // namespace cc
+
+#endif
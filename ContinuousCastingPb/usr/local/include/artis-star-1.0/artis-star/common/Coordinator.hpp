@@ -122,6 +122,22 @@ public :
                                                 const typename Time::type& t) =0;
     virtual typename Time::type start(const typename Time::type& t) =0;
     virtual typename Time::type transition(const typename Time::type& t) =0;
+
+    // y-message of one event of a child (see Sink), the event table is
+    // updated by end_dispatch(): by default, the event is dispatched in a bag
+    virtual void dispatch_event(Model < Time >* child, unsigned int port_index,
+                                const common::Value& value,
+                                const typename Time::type& t)
+    {
+        common::Bag < Time > bag;
+
+        bag.push_back(common::ExternalEvent < Time >(
+                          common::Node < Time >(child, port_index), value));
+        dispatch_events(bag, t);
+    }
+
+    virtual void end_dispatch(const typename Time::type& t)
+    { (void)t; }
 };
 
 } } // namespace artis common
@@ -50,6 +50,7 @@ public:
 
     void add_child(unsigned int index, common::Model < Time >* child)
     {
+        child->set_child_index(_children.size());
         _children.push_back(child);
         _child_map[index] = child;
         child->set_parent(_coordinator);
@@ -57,6 +58,7 @@ public:
 
     void add_children(unsigned int index, common::Model < Time >* child)
     {
+        child->set_child_index(_children.size());
         _children.push_back(child);
         if (_children_map.find(index) == _children_map.end()) {
             _children_map[index] = Models < Time >();
@@ -77,6 +79,10 @@ public:
     common::Coordinator < Time >* get_coordinator() const
     { return _coordinator; }
 
+    // couplings of the children, nullptr if they are not kept as links
+    virtual const common::Links < Time >* links() const
+    { return nullptr; }
+
 protected:
     common::Models < Time >        _children;
     common::ModelMap < Time >      _child_map;
@@ -31,11 +31,14 @@
 #include <artis-star/common/ExternalEvent.hpp>
 #include <artis-star/common/InternalEvent.hpp>
 #include <artis-star/common/Scheduler.hpp>
+#include <artis-star/common/Snapshot.hpp>
+#include <artis-star/common/TypedPort.hpp>
 #include <artis-star/common/Value.hpp>
 
 #include <algorithm>
 #include <cassert>
 #include <map>
+#include <memory>
 #include <iostream>
 #include <sstream>
 
@@ -64,15 +67,13 @@ class Model
 {
 public:
     Model(const std::string& name) :
-        _tl(0), _tn(0), _parent(0), _name(name), _inputs(0)
+        _tl(0), _tn(0), _parent(0), _coordinator(0), _child_index(0),
+        _name(name),
+        _typed_event_number(0)
     { }
 
     virtual ~Model()
-    {
-        if (_inputs) {
-            delete _inputs;
-        }
-    }
+    { }
 
     // structure
     void add_in_port(const Port& port)
@@ -139,6 +140,14 @@ public:
     Model < Time >* get_parent() const
     { return _parent; }
 
+    // coordinator which schedules the model and routes its outputs: the
+    // parent or, once the hierarchy is flattened, the flat coordinator
+    Model < Time >* get_coordinator() const
+    { return _coordinator; }
+
+    void set_coordinator(Model < Time >* coordinator)
+    { _coordinator = coordinator; }
+
     // TODO: to remove
     virtual int get_receiver_number(typename Time::type t)
     { (void)t; return 0; }
@@ -165,44 +174,97 @@ public:
     { return (_parent != nullptr ? _parent->path() : "") + ":" + get_name(); }
 
     void set_parent(Model < Time >* parent)
-    { _parent = parent; }
+    {
+        _parent = parent;
+        _coordinator = parent;
+    }
+
+    // rank of the model in the children of its parent
+    unsigned int get_child_index() const
+    { return _child_index; }
+
+    void set_child_index(unsigned int index)
+    { _child_index = index; }
 
     virtual std::string to_string(int /* level */) const =0;
 
     // event
     void add_event(const common::ExternalEvent < Time >& message)
     {
-        if (_inputs == 0) {
-            _inputs = new Bag < Time >;
+        if (event_number() == 0 and _coordinator) {
+            _coordinator->add_receiver(this);
+        }
+        _inputs.push_back(message);
+    }
+
+    // child received its first input since its last transition
+    virtual void add_receiver(Model < Time >* child)
+    { (void)child; }
+
+    // event on a typed port (see Input)
+    void add_typed_event()
+    {
+        if (event_number() == 0 and _coordinator) {
+            _coordinator->add_receiver(this);
         }
-        _inputs->push_back(message);
+        ++_typed_event_number;
     }
 
+    // the storage of the events is kept for the next steps
     void clear_bag()
     {
-        if (_inputs) {
-            delete _inputs;
-            _inputs = 0;
+        _inputs.clear();
+        if (_typed_event_number > 0) {
+            for (auto & input : _typed_inputs) {
+                if (input) {
+                    input->clear();
+                }
+            }
+            _typed_event_number = 0;
         }
     }
 
     unsigned int event_number() const
+    { return _inputs.size() + _typed_event_number; }
+
+    // typed ports, created on first use
+    template < class T >
+    Input < Time, T >& typed_input(unsigned int port_index)
     {
-        if (_inputs) {
-            return _inputs->size();
-        } else {
-            return 0;
+        if (port_index >= _typed_inputs.size()) {
+            _typed_inputs.resize(port_index + 1);
         }
+        if (not _typed_inputs[port_index]) {
+            _typed_inputs[port_index].reset(new Input < Time, T >(this));
+        }
+
+        assert((dynamic_cast < Input < Time, T >* >(
+                    _typed_inputs[port_index].get())));
+
+        return static_cast < Input < Time, T >& >(
+            *_typed_inputs[port_index]);
     }
 
-    const common::Bag < Time >& get_bag()
+    template < class T >
+    Output < Time, T >& typed_output(unsigned int port_index)
     {
-        if (_inputs == 0) {
-            _inputs = new Bag < Time >;
+        if (port_index >= _typed_outputs.size()) {
+            _typed_outputs.resize(port_index + 1);
+        }
+        if (not _typed_outputs[port_index]) {
+            _typed_outputs[port_index].reset(new Output < Time, T >());
         }
-        return *_inputs;
+
+        assert((dynamic_cast < Output < Time, T >* >(
+                    _typed_outputs[port_index].get())));
+
+        return static_cast < Output < Time, T >& >(
+            *_typed_outputs[port_index]);
     }
 
+    const common::Bag < Time >& get_bag()
+    { return _inputs; }
+
     // time
     typename Time::type get_tl() const
     { return _tl; }
@@ -219,6 +281,13 @@ public:
     virtual typename Time::type start(const typename Time::type& t) =0;
     virtual typename Time::type transition(const typename Time::type& t) =0;
 
+    // checkpoint, only between two steps
+    virtual void save(Snapshot < Time >& snapshot) const
+    { (void)snapshot; assert(false); }
+
+    virtual void restore(const Snapshot < Time >& snapshot)
+    { (void)snapshot; assert(false); }
+
     // scheduler
     void handle(SchedulerHandle handle)
     { _handle.handle(handle); }
@@ -232,14 +301,21 @@ protected:
 
 private :
     Model < Time >* _parent;
+    Model < Time >* _coordinator;
+    unsigned int    _child_index;
     std::string     _name;
     Ports           _in_ports;
     PortMap         _in_port_map;
     Ports           _out_ports;
     PortMap         _out_port_map;
 
-    Bag < Time >*   _inputs;
+    Bag < Time >    _inputs;
     SchedulerHandle _handle;
+
+    // indexed by port index
+    std::vector < std::unique_ptr < PortBuffer > > _typed_inputs;
+    std::vector < std::unique_ptr < PortBuffer > > _typed_outputs;
+    unsigned int                                   _typed_event_number;
 };
 
 template < class Time >
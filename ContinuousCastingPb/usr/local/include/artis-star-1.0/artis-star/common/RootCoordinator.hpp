@@ -47,7 +47,7 @@ public :
         const typename Coordinator::parameters_type& parameters,
         const typename Coordinator::graph_parameters_type& graph_parameters) :
         _root(root_name, parameters, graph_parameters), _observer(&_root),
-        _t_max(t_max), _tn(t_start)
+        _t_start(t_start), _t_max(t_max), _tn(t_start)
     { }
 
     RootCoordinator(const typename Time::type& t_start,
@@ -55,14 +55,14 @@ public :
                     const std::string& root_name,
                     const typename Coordinator::parameters_type& parameters) :
         _root(root_name, parameters, NoParameters()), _observer(&_root),
-        _t_max(t_max), _tn(t_start)
+        _t_start(t_start), _t_max(t_max), _tn(t_start)
     { }
 
     RootCoordinator(const typename Time::type& t_start,
                     const typename Time::type& t_max,
                     const std::string& root_name) :
         _root(root_name, NoParameters(), NoParameters()), _observer(&_root),
-        _t_max(t_max), _tn(t_start)
+        _t_start(t_start), _t_max(t_max), _tn(t_start)
     { }
 
     virtual ~RootCoordinator()
@@ -74,11 +74,51 @@ public :
     const observer::Observer < Time >& observer() const
     { return _observer; }
 
+    const Coordinator& root() const
+    { return _root; }
+
+    // settings of the root coordinator (see pdevs::Coordinator)
+    Coordinator& root()
+    { return _root; }
+
+    // each call restarts the simulation from t_start: the models are
+    // reinitialized by start() instead of being built again
     void run()
+    { run([](const typename Time::type& /* tn */) { return false; }); }
+
+    // same as run() but stops as soon as stop(tn) returns true, tn being
+    // the time of the next step
+    template < class Stop >
+    void run(Stop stop)
     {
         _observer.init();
-        _tn = _root.start(_tn);
-        while (_tn <= _t_max) {
+        _tn = _root.start(_t_start);
+        resume(stop);
+    }
+
+    // false if the run cannot be restored from this step
+    bool save(Snapshot < Time >& snapshot) const
+    {
+        snapshot.clear();
+        _root.save(snapshot);
+        return snapshot.valid();
+    }
+
+    // the views are not restored: they keep the values of the steps
+    // between the checkpoint and the restoration
+    void restore(const Snapshot < Time >& snapshot)
+    {
+        snapshot.rewind();
+        _root.restore(snapshot);
+        _tn = _root.get_tn();
+    }
+
+    // continue the current run (after a restoration for instance) until
+    // t_max or until stop(tn) returns true
+    template < class Stop >
+    void resume(Stop stop)
+    {
+        while (_tn <= _t_max and not stop(_tn)) {
             _root.output(_tn);
             _tn = _root.transition(_tn);
             _observer.observe(_tn);
@@ -96,6 +136,7 @@ public :
 private :
     Coordinator                 _root;
     observer::Observer < Time > _observer;
+    typename Time::type         _t_start;
     typename Time::type         _t_max;
     typename Time::type         _tn;
 };
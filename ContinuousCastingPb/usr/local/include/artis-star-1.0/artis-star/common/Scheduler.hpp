@@ -28,6 +28,7 @@
 #define COMMON_SCHEDULER 1
 
 #include <artis-star/common/scheduler/HeapScheduler.hpp>
+#include <artis-star/common/scheduler/IndexedHeapScheduler.hpp>
 
 namespace artis { namespace common {
 
@@ -36,22 +37,34 @@ struct SchedulerHandle;
 typedef typename artis::common::scheduler::HeapScheduler <
     common::DoubleTime, SchedulerHandle >::type SchedulerType;
 
+typedef typename artis::common::scheduler::IndexedHeapScheduler <
+    common::DoubleTime, SchedulerHandle >::type IndexedSchedulerType;
+
 struct SchedulerHandle
 {
-    SchedulerHandle()
+    SchedulerHandle() : _index(0)
     { }
 
     SchedulerHandle(const SchedulerType::handle_type& handle)
-        : _handle(handle)
+        : _handle(handle), _index(0)
+    { }
+
+    explicit SchedulerHandle(size_t index) : _index(index)
     { }
 
     const SchedulerHandle& handle() const
     { return *this; }
 
     void handle(const SchedulerHandle& handle)
-    { _handle = handle._handle; }
+    {
+        _handle = handle._handle;
+        _index = handle._index;
+    }
 
+    // handle in a HeapScheduler
     SchedulerType::handle_type _handle;
+    // index in an IndexedHeapScheduler
+    size_t                     _index;
 };
 
 } } // namespace artis common
@@ -0,0 +1,85 @@
+/**
+ * @file Sink.hpp
+ * @author The ARTIS Development Team
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * ARTIS - the multimodeling and simulation environment
+ * This file is a part of the ARTIS environment
+ *
+ * Copyright (C) 2013-2018 ULCO http://www.univ-littoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMMON_SINK
+#define COMMON_SINK 1
+
+#include <artis-star/common/Coordinator.hpp>
+#include <artis-star/common/Model.hpp>
+#include <artis-star/common/TypedPort.hpp>
+#include <artis-star/common/Value.hpp>
+
+namespace artis { namespace common {
+
+template < class Time >
+class Coordinator;
+
+template < class Time >
+class Model;
+
+/**
+ * Outputs of an atomic model at t: each event is routed by the parent
+ * coordinator as soon as it is emitted, straight into the inputs of its
+ * receivers, without building a bag
+ */
+template < class Time >
+class Sink
+{
+public:
+    Sink(Model < Time >* model, Coordinator < Time >* parent,
+         const typename Time::type& t) :
+        _model(model), _parent(parent), _t(t), _size(0)
+    { }
+
+    // an event on a port without link is lost
+    void emit(unsigned int port_index, const Value& value)
+    {
+        _parent->dispatch_event(_model, port_index, value, _t);
+        ++_size;
+    }
+
+    // the event goes straight into the typed inputs of the receivers
+    template < class T >
+    void emit(const OutPort < T >& port, const T& value)
+    {
+        _model->template typed_output < T >(port.index).emit(value);
+        ++_size;
+    }
+
+    // number of emitted events
+    unsigned int size() const
+    { return _size; }
+
+private:
+    Model < Time >*       _model;
+    Coordinator < Time >* _parent;
+    typename Time::type   _t;
+    unsigned int          _size;
+};
+
+} } // namespace artis common
+
+#endif
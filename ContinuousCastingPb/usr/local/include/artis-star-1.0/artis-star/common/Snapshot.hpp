@@ -0,0 +1,120 @@
+/**
+ * @file Snapshot.hpp
+ * @author The ARTIS Development Team
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * ARTIS - the multimodeling and simulation environment
+ * This file is a part of the ARTIS environment
+ *
+ * Copyright (C) 2013-2018 ULCO http://www.univ-littoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMMON_SNAPSHOT
+#define COMMON_SNAPSHOT 1
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+namespace artis { namespace common {
+
+/**
+ * State of a model hierarchy between two steps of a simulation: all the
+ * bags are empty, so the times of the models and the states of the dynamics
+ * are enough. The models write and read their entry in the same order
+ * (depth-first) and the entries are reused by the next saves.
+ */
+template < class Time >
+class Snapshot
+{
+public:
+    struct State
+    {
+        virtual ~State()
+        { }
+    };
+
+    // copy of the dynamics of an atomic model
+    template < class T >
+    struct Copy : State
+    {
+        Copy(const T& value) : value(value)
+        { }
+
+        T value;
+    };
+
+    struct Entry
+    {
+        typename Time::type       tl;
+        typename Time::type       tn;
+        std::unique_ptr < State > state;
+    };
+
+    Snapshot() : _size(0), _index(0), _valid(false)
+    { }
+
+    bool empty() const
+    { return _size == 0; }
+
+    // start a new save, the entries of the previous one are kept
+    void clear()
+    {
+        _size = 0;
+        _index = 0;
+        _valid = true;
+    }
+
+    // a model cannot be restored in the same state
+    void invalidate()
+    { _valid = false; }
+
+    bool valid() const
+    { return _valid; }
+
+    // entry of the next model to save
+    Entry& write()
+    {
+        if (_size == _entries.size()) {
+            _entries.push_back(Entry());
+        }
+        return _entries[_size++];
+    }
+
+    // start reading from the first model
+    void rewind() const
+    { _index = 0; }
+
+    // entry of the next model to restore
+    const Entry& read() const
+    {
+        assert(_index < _size);
+
+        return _entries[_index++];
+    }
+
+private:
+    std::vector < Entry > _entries;
+    size_t                _size;
+    mutable size_t        _index;
+    bool                  _valid;
+};
+
+} } // namespace artis common
+
+#endif
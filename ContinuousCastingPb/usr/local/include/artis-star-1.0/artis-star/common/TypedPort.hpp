@@ -0,0 +1,126 @@
+/**
+ * @file TypedPort.hpp
+ * @author The ARTIS Development Team
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * ARTIS - the multimodeling and simulation environment
+ * This file is a part of the ARTIS environment
+ *
+ * Copyright (C) 2013-2018 ULCO http://www.univ-littoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMMON_TYPED_PORT
+#define COMMON_TYPED_PORT 1
+
+#include <vector>
+
+namespace artis { namespace common {
+
+template < class Time >
+class Model;
+
+/**
+ * Ports whose events carry a T: the events are stored and delivered as T
+ * (no Value) and the coupling of two ports with different types does not
+ * compile. A typed port only links two children of the same coupled model.
+ */
+template < class T >
+struct InPort
+{
+    typedef T type;
+
+    unsigned int index;
+};
+
+template < class T >
+struct OutPort
+{
+    typedef T type;
+
+    unsigned int index;
+};
+
+// i-th port of a family
+template < class T >
+constexpr InPort < T > operator+(const InPort < T >& port, unsigned int i)
+{ return InPort < T >{ port.index + i }; }
+
+template < class T >
+constexpr OutPort < T > operator+(const OutPort < T >& port, unsigned int i)
+{ return OutPort < T >{ port.index + i }; }
+
+// storage of a typed port in its model
+struct PortBuffer
+{
+    virtual ~PortBuffer()
+    { }
+
+    virtual void clear()
+    { }
+};
+
+// events received since the last transition
+template < class Time, class T >
+class Input : public PortBuffer
+{
+public:
+    Input(Model < Time >* model) : _model(model)
+    { }
+
+    void push(const T& value)
+    {
+        _model->add_typed_event();
+        _values.push_back(value);
+    }
+
+    const std::vector < T >& values() const
+    { return _values; }
+
+    // the storage is kept for the next steps
+    void clear()
+    { _values.clear(); }
+
+private:
+    Model < Time >*  _model;
+    std::vector < T > _values;
+};
+
+template < class Time, class T >
+class Output : public PortBuffer
+{
+public:
+    Output()
+    { }
+
+    void add_receiver(Input < Time, T >* input)
+    { _receivers.push_back(input); }
+
+    void emit(const T& value) const
+    {
+        for (Input < Time, T >* input : _receivers) {
+            input->push(value);
+        }
+    }
+
+private:
+    std::vector < Input < Time, T >* > _receivers;
+};
+
+} } // namespace artis common
+
+#endif
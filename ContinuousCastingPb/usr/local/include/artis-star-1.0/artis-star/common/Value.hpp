@@ -30,7 +30,10 @@
 #include <boost/serialization/serialization.hpp>
 #include <boost/serialization/array.hpp>
 
+#include <cassert>
+#include <cstddef>
 #include <cstring>
+#include <type_traits>
 #include <typeinfo>
 #include <vector>
 
@@ -38,35 +41,44 @@
 
 namespace artis { namespace common {
 
+/**
+ * Copy of a value of any type sent on a port. The values up to SMALL_SIZE
+ * bytes (the slabs and the stack data of the CC model for instance) are
+ * stored inside the object: constructing, copying and moving them does not
+ * allocate.
+ */
 class Value
 {
 public:
-    Value() : _content(nullptr), _size(0)
+    static const size_t SMALL_SIZE = 80;
+
+    Value() : _content(nullptr), _size(0), _type_id(0)
     { }
 
-    template < typename T >
-    Value(T value)
-    { assign(&value, sizeof(T), typeid(T).hash_code()); }
+    template < typename T, typename = typename std::enable_if <
+                   not std::is_same < typename std::decay < T >::type,
+                                      Value >::value >::type >
+    Value(T value) : Value()
+    { assign(&value, sizeof(T), type_id < T >()); }
 
-    Value(void* content, size_t size)
-    { assign(content, size, typeid(void*).hash_code()); }
+    Value(void* content, size_t size) : Value()
+    { assign(content, size, type_id < void* >()); }
 
-    Value(const char* value, unsigned int size)
-    { assign(value, size * sizeof(char), typeid(char*).hash_code()); }
+    Value(const char* value, unsigned int size) : Value()
+    { assign(value, size * sizeof(char), type_id < char* >()); }
 
-    Value(const Value& value)
+    Value(const Value& value) : Value()
     {
         if (value._content) {
             assign(value._content, value._size, value._type_id);
-        } else {
-            _content = nullptr;
-            _size = 0;
-            _type_id = 0;
         }
     }
 
+    Value(Value&& value) : Value()
+    { steal(value); }
+
     virtual ~Value()
-    { if (_content != nullptr) delete[] _content; }
+    { release(); }
 
     bool empty() const
     { return _content == nullptr; }
@@ -74,29 +86,34 @@ public:
     template < typename T >
     void operator()(T& value) const
     {
-        assert(_type_id == typeid(T).hash_code());
+        assert(_type_id == type_id < T >());
 
         value = *(T*)(_content);
     }
 
     template < typename Z >
     bool is_type() const
-    { return _type_id == typeid(Z).hash_code(); }
+    { return _type_id == type_id < Z >(); }
 
-    void operator=(const Value& value)
+    Value& operator=(const Value& value)
     {
-        if (_content) {
-            delete _content;
-        }
-        if (value._content) {
-            assign(value._content, value._size, value._type_id);
-        } else {
-            _content = nullptr;
-            _size = 0;
-            _type_id = 0;
+        if (this != &value) {
+            release();
+            if (value._content) {
+                assign(value._content, value._size, value._type_id);
+            }
         }
+        return *this;
     }
 
+    Value& operator=(Value&& value)
+    {
+        if (this != &value) {
+            release();
+            steal(value);
+        }
+        return *this;
+    }
 
     std::string to_string() const
     {
@@ -136,14 +153,58 @@ public:
     }
 
 private:
+    // typeid(T).hash_code() computed once per type, the same in all the
+    // processes of a distributed simulation
+    template < typename T >
+    static size_t type_id()
+    {
+        static const size_t id = typeid(T).hash_code();
+
+        return id;
+    }
+
+    bool small() const
+    { return _content == _buffer; }
+
+    // storage for size bytes, the value must be empty
+    void allocate(size_t size)
+    {
+        _content = size <= SMALL_SIZE ? _buffer : new char[size];
+        _size = size;
+    }
+
     void assign(const void* content, size_t size, size_t type_id)
     {
-        _content = new char[size];
+        allocate(size);
         std::memcpy(_content, content, size);
-        _size = size;
         _type_id = type_id;
     }
 
+    void release()
+    {
+        if (_content != nullptr and not small()) {
+            delete[] _content;
+        }
+        _content = nullptr;
+        _size = 0;
+        _type_id = 0;
+    }
+
+    // value is left empty
+    void steal(Value& value)
+    {
+        if (value.small()) {
+            assign(value._content, value._size, value._type_id);
+            value.release();
+        } else {
+            _content = value._content;
+            _size = value._size;
+            _type_id = value._type_id;
+            value._content = nullptr;
+            value.release();
+        }
+    }
+
     friend class boost::serialization::access;
 
     template<class Archive>
@@ -151,10 +212,12 @@ private:
     {
         (void) version;
 
-        ar & _size;
+        size_t size = _size;
+
+        ar & size;
         if (Archive::is_loading::value) {
             assert(_content == nullptr);
-            _content = new char[_size];
+            allocate(size);
         }
         ar & boost::serialization::make_array < char >(_content, _size);
         ar & _type_id;
@@ -163,6 +226,7 @@ private:
     char*  _content;
     size_t _size;
     size_t _type_id;
+    alignas(std::max_align_t) char _buffer[SMALL_SIZE];
 };
 
 } } // namespace artis common
@@ -76,7 +76,12 @@ public:
     { return _views; }
 
     void init()
-    { }
+    {
+        for (typename Views::iterator it = _views.begin(); it != _views.end();
+             ++it) {
+            it->second->init();
+        }
+    }
 
     void observe(double t)
     {
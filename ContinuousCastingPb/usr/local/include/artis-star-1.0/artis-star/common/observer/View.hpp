@@ -31,11 +31,23 @@
 #include <artis-star/common/time/DoubleTime.hpp>
 #include <artis-star/common/Value.hpp>
 
-#include <boost/format.hpp>
-#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
 
 namespace artis { namespace observer {
 
+/**
+ * Time series of observables of the models. The selectors are resolved
+ * when the model is attached: each observed variable (a model and an
+ * observable) gets a column, the int, double and bool values are stored
+ * in typed columns beside one time column shared by the variables. The
+ * columns keep their capacity between two runs: an observation is a call
+ * to observe() and a store by variable. The values by selector and
+ * variable (get(), values()) are built on demand from the columns.
+ */
 template < typename Time >
 class View
 {
@@ -48,14 +60,28 @@ public:
 
     enum vars { ALL = -1 };
 
-    View() : _model(0)
+    View() : _model(0), _built_sample_number(0)
     { }
 
     virtual ~View()
     { }
 
     void attachModel(const artis::common::Model < Time >* m)
-    { _model = m; }
+    {
+        _model = m;
+        resolve();
+    }
+
+    // forget the values of the previous run
+    void init()
+    {
+        _times.clear();
+        for (Column& column : _columns) {
+            column.clear();
+        }
+        _values.clear();
+        _built_sample_number = 0;
+    }
 
     double begin() const
     {
@@ -103,28 +129,18 @@ public:
         return t;
     }
 
+    // first value of the variable observed at t or later, 0 if none
     double get(double t, const std::string& selector_name,
                const std::string& variable_name) const
     {
-        SelectorValues::const_iterator it = _values.find(selector_name);
-
-        if (it != _values.end()) {
-            VariableValues::const_iterator itp = it->second.find(variable_name);
+        const Column* column = find(selector_name, variable_name);
 
-            if (itp != it->second.end()) {
-                Values::const_iterator itv = itp->second.begin();
+        if (column) {
+            size_t i = std::lower_bound(_times.begin(), _times.end(), t) -
+                _times.begin();
 
-                while (itv != itp->second.end() and itv->first < t) {
-                    ++itv;
-                }
-                if (itv != itp->second.end()) {
-                    // TODO: to improve
-                    return boost::lexical_cast < double >(itv->second);
-                } else {
-                    return 0;
-                }
-            } else {
-                return 0;
+            if (i < _times.size()) {
+                return column->number(i);
             }
         }
         return 0;
@@ -133,50 +149,175 @@ public:
     const Values& get(const std::string& selector_name,
                       const std::string& variable_name) const
     {
-        SelectorValues::const_iterator it = _values.find(selector_name);
+        const SelectorValues& values = this->values();
+        typename SelectorValues::const_iterator it =
+            values.find(selector_name);
 
-        if (it != _values.end()) {
-            VariableValues::const_iterator itv = it->second.find(variable_name);
+        assert(it != values.end());
 
-            if (itv != it->second.end()) {
-                return itv->second;
-            } else {
-                assert(false);
-            }
-        } else {
-            assert(false);
-        }
+        typename VariableValues::const_iterator itv =
+            it->second.find(variable_name);
+
+        assert(itv != it->second.end());
+
+        return itv->second;
     }
 
     const Values& get(const std::string& selector_name) const
     {
-        SelectorValues::const_iterator it = _values.find(selector_name);
+        const SelectorValues& values = this->values();
+        typename SelectorValues::const_iterator it =
+            values.find(selector_name);
 
-        if (it != _values.end()) {
-            assert(it->second.size() == 1);
+        assert(it != values.end());
+        assert(it->second.size() == 1);
 
-            return it->second.begin()->second;
-        } else {
-            assert(false);
+        return it->second.begin()->second;
+    }
+
+    virtual void observe(double time)
+    {
+        _times.push_back(time);
+        for (Column& column : _columns) {
+            column.push_back(column.model->observe(time, column.index));
         }
     }
 
-    void observe(double time, const common::Model < common::DoubleTime >* model,
-                 const std::string& selector_name, unsigned int variable_index)
+    void selector(const std::string& name, const Selector& chain)
     {
-        std::string path = (boost::format("%1%:%2%") % model->path() %
-                            model->observable_name(variable_index)).str() ;
-        VariableValues& values = _values[selector_name];
+        _selectors[name] = chain;
+        resolve();
+    }
+
+    // the values by selector and by variable
+    const SelectorValues& values() const
+    {
+        if (_built_sample_number != _times.size() or _values.empty()) {
+            build();
+        }
+        return _values;
+    }
+
+private:
+    typedef std::map < std::string, Selector > Selectors;
+
+    // samples of a variable, in a typed column for the int, double and
+    // bool values and as values for the other types
+    struct Column
+    {
+        enum Type { NONE, INT, DOUBLE, BOOL, VALUE };
+
+        std::string                                 selector_name;
+        std::string                                 variable_name;
+        const common::Model < common::DoubleTime >* model;
+        unsigned int                                index;
+
+        Type                                        type;
+        std::vector < int >                         ints;
+        std::vector < double >                      doubles;
+        std::vector < bool >                        bools;
+        std::vector < common::Value >               values;
+
+        void clear()
+        {
+            type = NONE;
+            ints.clear();
+            doubles.clear();
+            bools.clear();
+            values.clear();
+        }
+
+        void push_back(const common::Value& value)
+        {
+            if (type == NONE) {
+                type = value.is_type < int >() ? INT :
+                    value.is_type < double >() ? DOUBLE :
+                    value.is_type < bool >() ? BOOL : VALUE;
+            }
+            if (type == INT and value.is_type < int >()) {
+                int v;
+
+                value(v);
+                ints.push_back(v);
+            } else if (type == DOUBLE and value.is_type < double >()) {
+                double v;
+
+                value(v);
+                doubles.push_back(v);
+            } else if (type == BOOL and value.is_type < bool >()) {
+                bool v;
 
-        if (values.find(path) == values.end()) {
-            values[path] = Values();
+                value(v);
+                bools.push_back(v);
+            } else {
+                if (type != VALUE) {
+                    for (size_t i = 0; i < size(); ++i) {
+                        values.push_back(get(i));
+                    }
+                    ints.clear();
+                    doubles.clear();
+                    bools.clear();
+                    type = VALUE;
+                }
+                values.push_back(value);
+            }
+        }
+
+        size_t size() const
+        {
+            switch (type) {
+            case INT: return ints.size();
+            case DOUBLE: return doubles.size();
+            case BOOL: return bools.size();
+            case VALUE: return values.size();
+            default: return 0;
+            }
+        }
+
+        common::Value get(size_t i) const
+        {
+            switch (type) {
+            case INT: return ints[i];
+            case DOUBLE: return doubles[i];
+            case BOOL: return (bool)bools[i];
+            case VALUE: return values[i];
+            default: return common::Value();
+            }
+        }
+
+        double number(size_t i) const
+        {
+            switch (type) {
+            case INT: return ints[i];
+            case DOUBLE: return doubles[i];
+            case BOOL: return bools[i];
+            case VALUE: return std::atof(values[i].to_string().c_str());
+            default: return 0;
+            }
+        }
+    };
+
+    // the columns of the variables selected by the chains, in the order of
+    // the selectors then of the models
+    void resolve()
+    {
+        if (not _model) {
+            return;
+        }
+        _columns.clear();
+        for (typename Selectors::const_iterator it = _selectors.begin();
+             it != _selectors.end(); ++it) {
+            if (it->second.size() > 1) {
+                resolve(it->second, 0, _model, it->first, it->second.back());
+            } else {
+                resolve(_model, it->first, it->second.back());
+            }
         }
-        values[path].push_back(
-            std::make_pair(time, model->observe(time, variable_index)));
+        init();
     }
 
-    void observe(const Selector& chain, unsigned int i,
-                 double time, const common::Model < common::DoubleTime >* model,
+    void resolve(const Selector& chain, unsigned int i,
+                 const common::Model < common::DoubleTime >* model,
                  const std::string& selector_name, unsigned int variable_index)
     {
         while (i < chain.size() - 1 and chain[i + 1] != ALL and model) {
@@ -189,51 +330,66 @@ public:
                  model_index < model->get_submodel_number(chain[i]);
                  ++model_index) {
                 assert(chain[i] >= 0);
-                observe(chain, i + 2, time,
+                resolve(chain, i + 2,
                         model->get_submodel((unsigned int)chain[i],
                                             model_index),
                         selector_name, variable_index);
             }
         } else {
-            if (model) {
-                observe(time, model, selector_name, variable_index);
-            }
+            resolve(model, selector_name, variable_index);
         }
     }
 
-    virtual void observe(double time)
+    void resolve(const common::Model < common::DoubleTime >* model,
+                 const std::string& selector_name, unsigned int variable_index)
     {
-        for (typename Selectors::const_iterator it = _selectors.begin();
-             it != _selectors.end(); ++it) {
-            const common::Model < common::DoubleTime >* model = _model;
-
-            if (it->second.size() > 1) {
-                size_t i = 0;
+        if (model) {
+            Column column;
+
+            column.selector_name = selector_name;
+            column.variable_name = model->path() + ":" +
+                model->observable_name(variable_index);
+            column.model = model;
+            column.index = variable_index;
+            column.type = Column::NONE;
+            _columns.push_back(column);
+        }
+    }
 
-                observe(it->second, i, time, model, it->first,
-                        it->second.back());
-            } else {
-                if (model) {
-                    observe(time, model, it->first, it->second.back());
-                }
+    const Column* find(const std::string& selector_name,
+                       const std::string& variable_name) const
+    {
+        for (const Column& column : _columns) {
+            if (column.selector_name == selector_name and
+                column.variable_name == variable_name) {
+                return &column;
             }
         }
+        return nullptr;
     }
 
-    void selector(const std::string& name, const Selector& chain)
+    void build() const
     {
-        _selectors[name] = chain;
+        _values.clear();
+        for (const Column& column : _columns) {
+            Values& values = _values[column.selector_name][
+                column.variable_name];
+
+            values.reserve(values.size() + _times.size());
+            for (size_t i = 0; i < _times.size(); ++i) {
+                values.emplace_back(_times[i], column.get(i));
+            }
+        }
+        _built_sample_number = _times.size();
     }
 
-    const SelectorValues& values() const
-    { return _values;}
-
-private:
-    typedef std::map < std::string, Selector > Selectors;
-
     Selectors                            _selectors;
-    SelectorValues                       _values;
     const artis::common::Model < Time >* _model;
+    std::vector < Column >               _columns;
+    std::vector < double >               _times;
+    // built from the columns by values()
+    mutable SelectorValues               _values;
+    mutable size_t                       _built_sample_number;
 };
 
 } }
@@ -31,7 +31,9 @@
 
 #include <boost/heap/fibonacci_heap.hpp>
 
+#include <algorithm>
 #include <sstream>
+#include <stdexcept>
 
 namespace artis { namespace common {
 
@@ -52,6 +54,10 @@ class HeapScheduler :
 {
 public:
     typedef HeapScheduler < Time, T > type;
+    typedef boost::heap::fibonacci_heap <
+        InternalEvent < Time >,
+        boost::heap::compare <
+            EventCompare < InternalEvent < Time > > > > super_type;
     typedef Model < Time >            model_type;
     typedef Models < Time >           models_type;
     typedef InternalEvent < Time >    internal_event_type;
@@ -61,7 +67,7 @@ public:
     virtual ~HeapScheduler()
     { }
 
-    model_type* get_current_model()
+    model_type* get_current_model() const
     {
         return type::top().get_model();
     }
@@ -69,21 +75,37 @@ public:
     models_type get_current_models(typename Time::type time) const
     {
         models_type models;
-        typename models_type::iterator it;
 
-        for (typename type::ordered_iterator it = type::ordered_begin();
-             it != type::ordered_end() and it->get_time() == time; ++it) {
-            std::string str = it->get_model()->get_name();
-            auto it2 = find_if(models.begin(), models.end(),
-                               [&str](const model_type* obj) {
-                                   return obj->get_name() == str;
-                               });
-
-            if (it2 == models.end()) {
+        get_current_models(time, models);
+        return models;
+    }
+
+    // same as above in a reused vector. Only the public iterators of the
+    // heap are used: all the events are visited (IndexedHeapScheduler only
+    // visits the events at time) and the models are ordered by their index
+    // in the coupled model, whatever the shape of the heap. The ordered
+    // iterator is not used, it visits some nodes twice once the heap has
+    // been updated.
+    void get_current_models(typename Time::type time,
+                            models_type& models) const
+    {
+        models.clear();
+        for (typename type::iterator it = type::begin(); it != type::end();
+             ++it) {
+            if (it->get_time() == time) {
                 models.push_back(it->get_model());
             }
         }
-        return models;
+        std::sort(models.begin(), models.end(),
+                  [](const model_type* a, const model_type* b) {
+                      return a->get_child_index() < b->get_child_index();
+                  });
+        // a model has one event
+        if (std::adjacent_find(models.begin(), models.end()) !=
+            models.end()) {
+            throw std::logic_error("HeapScheduler: a model has several "
+                                   "events");
+        }
     }
 
     typename Time::type get_current_time() const
@@ -111,6 +133,17 @@ public:
         }
     }
 
+    // replace the events by a copy of the events of other, the models now
+    // refer to the copy
+    void restore(const type& other)
+    {
+        static_cast < typename type::super_type& >(*this) = other;
+        for (typename type::iterator it = type::begin(); it != type::end();
+             ++it) {
+            it->get_model()->handle(T(type::s_handle_from_iterator(it)));
+        }
+    }
+
     std::string to_string() const
     {
         std::stringstream ss;
@@ -0,0 +1,233 @@
+/**
+ * @file IndexedHeapScheduler.hpp
+ * @author The ARTIS Development Team
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * ARTIS - the multimodeling and simulation environment
+ * This file is a part of the ARTIS environment
+ *
+ * Copyright (C) 2013-2018 ULCO http://www.univ-littoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMMON_SCHEDULER_INDEXED_HEAP_SCHEDULER_HPP
+#define COMMON_SCHEDULER_INDEXED_HEAP_SCHEDULER_HPP 1
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+namespace artis { namespace common {
+
+template < class Time >
+class Model;
+
+template < class Time >
+class Models;
+
+namespace scheduler {
+
+/**
+ * 4-ary heap of the next events stored in a contiguous array: each model
+ * keeps the index of its event in its handle, so that put() moves the event
+ * without any search or allocation. The events with the same time are
+ * ordered by the rank of their model in the init() calls: the imminent
+ * models do not depend on the history of the heap.
+ */
+template < class Time, class T >
+class IndexedHeapScheduler
+{
+public:
+    typedef IndexedHeapScheduler < Time, T > type;
+    typedef Model < Time >                   model_type;
+    typedef Models < Time >                  models_type;
+
+    IndexedHeapScheduler()
+    { }
+
+    bool empty() const
+    { return _events.empty(); }
+
+    size_t size() const
+    { return _events.size(); }
+
+    void clear()
+    { _events.clear(); }
+
+    model_type* get_current_model() const
+    { return _events.front().model; }
+
+    models_type get_current_models(typename Time::type time) const
+    {
+        models_type models;
+
+        get_current_models(time, models);
+        return models;
+    }
+
+    // same as above in a reused vector
+    void get_current_models(typename Time::type time,
+                            models_type& models) const
+    {
+        models.clear();
+        // the events at time form a subtree below the root
+        if (not _events.empty() and _events.front().time == time) {
+            models.push_back(_events.front().model);
+        }
+        for (size_t i = 0; i < models.size(); ++i) {
+            size_t first = ARITY * models[i]->handle()._index + 1;
+            size_t last = std::min(first + ARITY, _events.size());
+
+            for (size_t child = first; child < last; ++child) {
+                if (_events[child].time == time) {
+                    models.push_back(_events[child].model);
+                }
+            }
+        }
+        std::sort(models.begin(), models.end(),
+                  [this](const model_type* a, const model_type* b) {
+                      return _events[a->handle()._index].rank <
+                          _events[b->handle()._index].rank;
+                  });
+    }
+
+    typename Time::type get_current_time() const
+    { return _events.front().time; }
+
+    void init(typename Time::type time, model_type* model)
+    {
+        Event event = { time, model, (unsigned int)_events.size() };
+
+        _events.push_back(event);
+        up(_events.size() - 1);
+    }
+
+    void put(typename Time::type time, const model_type* model)
+    {
+        size_t index = model->handle()._index;
+        typename Time::type previous_time = _events[index].time;
+
+        if (previous_time != time) {
+            _events[index].time = time;
+            if (time < previous_time) {
+                up(index);
+            } else {
+                down(index);
+            }
+        }
+    }
+
+    // replace the events by a copy of the events of other, the models now
+    // refer to the copy
+    void restore(const type& other)
+    {
+        _events = other._events;
+        for (size_t i = 0; i < _events.size(); ++i) {
+            _events[i].model->handle(T(i));
+        }
+    }
+
+    std::string to_string() const
+    {
+        std::vector < Event > events(_events);
+        std::stringstream ss;
+
+        std::sort(events.begin(), events.end());
+        ss << "Scheduler = { ";
+        for (const Event& event : events) {
+            ss << "(" << event.time << " -> " << event.model->get_name()
+               << ") ";
+        }
+        ss << "} [" << _events.size() << "]";
+        return ss.str();
+    }
+
+private:
+    static const size_t ARITY = 4;
+
+    struct Event
+    {
+        typename Time::type time;
+        model_type*         model;
+        unsigned int        rank;
+
+        bool operator<(const Event& other) const
+        {
+            return time < other.time or
+                (time == other.time and rank < other.rank);
+        }
+    };
+
+    void up(size_t index)
+    {
+        Event event = _events[index];
+
+        while (index > 0) {
+            size_t parent = (index - 1) / ARITY;
+
+            if (not (event < _events[parent])) {
+                break;
+            }
+            move(parent, index);
+            index = parent;
+        }
+        _events[index] = event;
+        event.model->handle(T(index));
+    }
+
+    void down(size_t index)
+    {
+        Event event = _events[index];
+        size_t size = _events.size();
+
+        for (;;) {
+            size_t first = ARITY * index + 1;
+
+            if (first >= size) {
+                break;
+            }
+
+            size_t last = std::min(first + ARITY, size);
+            size_t min = first;
+
+            for (size_t child = first + 1; child < last; ++child) {
+                if (_events[child] < _events[min]) {
+                    min = child;
+                }
+            }
+            if (not (_events[min] < event)) {
+                break;
+            }
+            move(min, index);
+            index = min;
+        }
+        _events[index] = event;
+        event.model->handle(T(index));
+    }
+
+    void move(size_t from, size_t to)
+    {
+        _events[to] = _events[from];
+        _events[to].model->handle(T(to));
+    }
+
+    std::vector < Event > _events;
+};
+
+} } } // namespace artis common scheduler
+
+#endif
@@ -24,225 +24,355 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+
 #ifndef COMMON_UTILS_MULTITHREADING
 #define COMMON_UTILS_MULTITHREADING 1
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
-#include <queue>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 namespace artis { namespace common {
 
-struct BaseMessage
-{
-    virtual ~BaseMessage()
-    { }
-};
-
-template < typename Msg >
-struct Message : BaseMessage
+/**
+ * Bounded lock-free mailbox, several producers and one consumer (bounded
+ * queue of D. Vyukov): the sequence number of a cell tells whether it can
+ * be written or read. Capacity must be a power of two.
+ */
+template < class T, size_t Capacity >
+class Mailbox
 {
-    explicit Message(Msg const& content) : _content(content)
-    { }
-
-    Msg _content;
-};
-
-class Close
-{ };
+    static_assert(Capacity > 1 and (Capacity & (Capacity - 1)) == 0,
+                  "the capacity of a mailbox is a power of two");
 
-class MessageQueue
-{
 public:
-    template < typename T >
-    void push(T const& msg)
+    Mailbox() : _head(0), _tail(0)
     {
-        std::lock_guard < std::mutex > lock(_mutex);
+        for (size_t i = 0; i < Capacity; ++i) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
 
-        _queue.push(std::make_shared < Message < T > >(msg));
-        _condition.notify_all();
+    // false if the mailbox is full
+    bool push(const T& value)
+    {
+        size_t position = _tail.load(std::memory_order_relaxed);
+        Cell* cell;
+
+        for (;;) {
+            cell = &_cells[position & (Capacity - 1)];
+
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            std::intptr_t difference =
+                (std::intptr_t)sequence - (std::intptr_t)position;
+
+            if (difference == 0) {
+                if (_tail.compare_exchange_weak(position, position + 1,
+                                                std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = _tail.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
     }
 
-    std::shared_ptr < BaseMessage > wait_and_pop()
+    // false if the mailbox is empty, only called by the consumer
+    bool pop(T& value)
     {
-        std::unique_lock < std::mutex > lock(_mutex);
+        Cell& cell = _cells[_head & (Capacity - 1)];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
 
-        _condition.wait(lock, [&]{ return not _queue.empty(); });
-        auto res = _queue.front();
-        _queue.pop();
-        return res;
+        if (sequence != _head + 1) {
+            return false;
+        }
+        value = cell.value;
+        cell.sequence.store(_head + Capacity, std::memory_order_release);
+        ++_head;
+        return true;
     }
 
 private:
-    std::mutex                                     _mutex;
-    std::condition_variable                        _condition;
-    std::queue < std::shared_ptr < BaseMessage > > _queue;
+    struct Cell
+    {
+        std::atomic < size_t > sequence;
+        T                      value;
+    };
+
+    Cell                   _cells[Capacity];
+    size_t                 _head;
+    std::atomic < size_t > _tail;
 };
 
-class Sender
+/**
+ * Bounded work-stealing deque of Chase and Lev: the owner pushes and pops
+ * at the bottom, the other threads steal at the top
+ */
+template < class T, size_t Capacity >
+class WorkDeque
 {
-public:
-    Sender() : _queue(0)
-    { }
+    static_assert(Capacity > 1 and (Capacity & (Capacity - 1)) == 0,
+                  "the capacity of a deque is a power of two");
 
-    explicit Sender(MessageQueue* queue) : _queue(queue)
+public:
+    WorkDeque() : _top(0), _bottom(0)
     { }
 
-    template < typename Message >
-    void send(Message const& msg)
+    // false if the deque is full
+    bool push(T* item)
     {
-        if (_queue) {
-            _queue->push(msg);
-        }
-    }
-
-private:
-    MessageQueue* _queue;
-};
-
-template < typename PreviousDispatcher, typename Msg, typename Func >
-class TemplateDispatcher
-{
-    template < typename Dispatcher, typename OtherMsg, typename OtherFunc >
-    friend class TemplateDispatcher;
+        long bottom = _bottom.load(std::memory_order_relaxed);
+        long top = _top.load(std::memory_order_acquire);
 
-public:
-    TemplateDispatcher(TemplateDispatcher&& other) : _queue(other._queue),
-                                                     _previous(other._previous),
-                                                     _function(
-                                                         std::move(
-                                                             other._function)),
-                                                     _chained(other._chained)
-    { other._chained = true; }
-
-    TemplateDispatcher(MessageQueue* queue,
-                       PreviousDispatcher* previous,
-                       Func&& function) :
-        _queue(queue), _previous(previous),
-        _function(std::forward < Func >(function)), _chained(false)
-    { previous->_chained = true; }
-
-    bool dispatch(std::shared_ptr < BaseMessage > const& msg)
-    {
-        Message < Msg >* message =
-            dynamic_cast < Message < Msg >* >(msg.get());
-
-        if (message) {
-            _function(message->_content);
-            return true;
-        } else {
-            return _previous->dispatch(msg);
+        if (bottom - top >= (long)Capacity) {
+            return false;
         }
+        _items[bottom & (Capacity - 1)].store(item, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+        return true;
     }
 
-    template < typename OtherMsg, typename OtherFunc >
-    TemplateDispatcher < TemplateDispatcher < PreviousDispatcher, Msg, Func >,
-                         OtherMsg, OtherFunc >
-    handle(OtherFunc&& of)
+    // last pushed item or nullptr
+    T* pop()
     {
-        return TemplateDispatcher < TemplateDispatcher < PreviousDispatcher,
-                                                         Msg, Func >,
-                                    OtherMsg, OtherFunc >(
-            _queue, this, std::forward < OtherFunc >(of));
+        long bottom = _bottom.load(std::memory_order_relaxed) - 1;
+
+        _bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        long top = _top.load(std::memory_order_relaxed);
+        T* item = nullptr;
+
+        if (top <= bottom) {
+            item = _items[bottom & (Capacity - 1)].load(
+                std::memory_order_relaxed);
+            if (top == bottom) {
+                // last item, the thieves may take it
+                if (not _top.compare_exchange_strong(
+                        top, top + 1, std::memory_order_seq_cst,
+                        std::memory_order_relaxed)) {
+                    item = nullptr;
+                }
+                _bottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+        } else {
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
     }
 
-    ~TemplateDispatcher() noexcept(false)
+    // first pushed item or nullptr
+    T* steal()
     {
-        if (not _chained) {
-            wait_and_dispatch();
-        }
-    }
+        long top = _top.load(std::memory_order_acquire);
 
-private:
-    TemplateDispatcher(TemplateDispatcher const&)=delete;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
 
-    TemplateDispatcher& operator=(TemplateDispatcher const&)=delete;
+        long bottom = _bottom.load(std::memory_order_acquire);
 
-    void wait_and_dispatch()
-    {
-        for(;;) {
-            auto msg = _queue->wait_and_pop();
+        if (top < bottom) {
+            T* item = _items[top & (Capacity - 1)].load(
+                std::memory_order_relaxed);
 
-            if (dispatch(msg)) {
-                break;
+            if (_top.compare_exchange_strong(top, top + 1,
+                                             std::memory_order_seq_cst,
+                                             std::memory_order_relaxed)) {
+                return item;
             }
         }
+        return nullptr;
     }
 
-    MessageQueue*       _queue;
-    PreviousDispatcher* _previous;
-    Func                _function;
-    bool                _chained;
+private:
+    std::atomic < long > _top;
+    std::atomic < long > _bottom;
+    std::atomic < T* >   _items[Capacity];
 };
 
-class Dispatcher
+/**
+ * Workers shared by the coordinators. A task submitted by a worker goes
+ * into the deque of this worker, a task submitted by another thread goes
+ * into the mailbox of a worker. An idle worker steals the tasks of the
+ * others and sleeps after a while. The tasks belong to the submitters.
+ */
+class WorkerPool
 {
-    template < typename Dispatcher, typename Msg, typename Func>
-    friend class TemplateDispatcher;
-
 public:
-    Dispatcher(Dispatcher&& other) : _queue(other._queue),
-                                     _chained(other._chained)
-    { other._chained = true; }
+    struct Task
+    {
+        virtual ~Task()
+        { }
 
-    explicit Dispatcher(MessageQueue* queue) : _queue(queue), _chained(false)
-    { }
+        virtual void run() = 0;
+    };
 
-    template < typename Message, typename Func >
-    TemplateDispatcher < Dispatcher, Message, Func >
-    handle(Func&& function)
+    explicit WorkerPool(unsigned int thread_number) :
+        _stop(false), _pending(0), _sleeping(0), _next(0)
     {
-        return TemplateDispatcher < Dispatcher, Message, Func >(
-            _queue, this, std::forward < Func >(function));
+        for (unsigned int i = 0; i < std::max(1U, thread_number); ++i) {
+            _workers.push_back(std::unique_ptr < Worker >(new Worker));
+            _workers.back()->pool = this;
+        }
+        for (unsigned int i = 0; i < _workers.size(); ++i) {
+            _workers[i]->thread = std::thread(&WorkerPool::loop, this, i);
+        }
     }
 
-    ~Dispatcher() noexcept(false)
+    ~WorkerPool()
     {
-        if (not _chained) {
-            wait_and_dispatch();
+        {
+            std::lock_guard < std::mutex > lock(_mutex);
+
+            _stop = true;
+        }
+        _condition.notify_all();
+        for (auto & worker : _workers) {
+            worker->thread.join();
         }
     }
 
-private:
-    Dispatcher(Dispatcher const&)=delete;
+    // pool of the process, one worker per core but the calling thread
+    static WorkerPool& pool()
+    {
+        static WorkerPool pool(std::thread::hardware_concurrency() > 1 ?
+                               std::thread::hardware_concurrency() - 1 : 1);
+
+        return pool;
+    }
 
-    Dispatcher& operator=(Dispatcher const&)=delete;
+    unsigned int size() const
+    { return _workers.size(); }
 
-    void wait_and_dispatch()
+    void submit(Task* task)
     {
-        for(;;) {
-            auto msg = _queue->wait_and_pop();
+        Worker* worker = current();
+        bool queued;
 
-            dispatch(msg);
+        _pending.fetch_add(1);
+        if (worker) {
+            queued = worker->deque.push(task);
+        } else {
+            queued = _workers[_next.fetch_add(1) % _workers.size()]->
+                mailbox.push(task);
+        }
+        if (not queued) {
+            _pending.fetch_sub(1);
+            task->run();
+        } else if (_sleeping.load() > 0) {
+            std::lock_guard < std::mutex > lock(_mutex);
+
+            // the owner of the mailbox may be asleep
+            _condition.notify_all();
         }
     }
 
-    bool dispatch(std::shared_ptr < BaseMessage > const& msg)
+    // runs a task of the pool, false if none was found
+    bool help()
     {
-        if (dynamic_cast < Message < Close >* >(msg.get())) {
-            throw Close();
+        Task* task = take(current());
+
+        if (task) {
+            task->run();
+            return true;
         }
         return false;
     }
 
-    MessageQueue* _queue;
-    bool          _chained;
-};
+private:
+    struct Worker
+    {
+        WorkDeque < Task, 1024 > deque;
+        Mailbox < Task*, 1024 >  mailbox;
+        std::thread              thread;
+        WorkerPool*              pool;
+    };
+
+    // worker of this pool running in the calling thread or nullptr
+    Worker* current() const
+    {
+        Worker* worker = current_worker();
 
-class Receiver
-{
-public:
-    Receiver()
-    { }
+        return worker and worker->pool == this ? worker : nullptr;
+    }
 
-    operator Sender()
-    { return Sender(&_queue); }
+    static Worker*& current_worker()
+    {
+        static thread_local Worker* worker = nullptr;
 
-    Dispatcher wait()
-    { return Dispatcher(&_queue); }
+        return worker;
+    }
 
-private:
-    MessageQueue _queue;
+    Task* take(Worker* worker)
+    {
+        Task* task = nullptr;
+
+        if (worker) {
+            while (worker->mailbox.pop(task)) {
+                if (not worker->deque.push(task)) {
+                    break;
+                }
+                task = nullptr;
+            }
+            if (not task) {
+                task = worker->deque.pop();
+            }
+        }
+        for (size_t i = 0; not task and i < _workers.size(); ++i) {
+            if (_workers[i].get() != worker) {
+                task = _workers[i]->deque.steal();
+            }
+        }
+        if (task) {
+            _pending.fetch_sub(1);
+        }
+        return task;
+    }
+
+    void loop(unsigned int index)
+    {
+        Worker* worker = _workers[index].get();
+        unsigned int idle = 0;
+
+        current_worker() = worker;
+        while (not _stop.load()) {
+            Task* task = take(worker);
+
+            if (task) {
+                task->run();
+                idle = 0;
+            } else if (++idle < 64) {
+                std::this_thread::yield();
+            } else {
+                std::unique_lock < std::mutex > lock(_mutex);
+
+                _sleeping.fetch_add(1);
+                _condition.wait_for(lock, std::chrono::milliseconds(1), [&] {
+                        return _stop.load() or _pending.load() > 0; });
+                _sleeping.fetch_sub(1);
+                idle = 0;
+            }
+        }
+    }
+
+    std::vector < std::unique_ptr < Worker > > _workers;
+    std::atomic < bool >                       _stop;
+    std::atomic < int >                        _pending;
+    std::atomic < int >                        _sleeping;
+    std::atomic < unsigned int >               _next;
+    std::mutex                                 _mutex;
+    std::condition_variable                    _condition;
 };
 
 } }  // namespace artis common
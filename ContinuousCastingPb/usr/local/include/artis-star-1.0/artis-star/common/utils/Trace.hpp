@@ -159,14 +159,15 @@ class Trace
 {
 public:
     virtual ~Trace()
-    { }
+    { delete _sstream; }
 
+    // one trace per thread: simulations running concurrently on several
+    // threads never interleave their elements
     static Trace& trace()
     {
-        std::call_once(_flag, [] ()
-                       { _instance.reset(new Trace()); }
-            );
-        return *_instance;
+        static thread_local Trace instance;
+
+        return instance;
     }
 
     void clear()
@@ -205,9 +206,6 @@ private:
     Trace()
     { _sstream = 0; }
 
-    static std::shared_ptr < Trace < Time > > _instance;
-    static std::once_flag _flag;
-
     TraceElements < Time > _trace;
     TraceElement < Time >  _element;
     std::ostringstream*    _sstream;
@@ -249,11 +247,4 @@ artis::common::Trace < Time >& operator<<(
     return trace;
 }
 
-template < class Time >
-std::shared_ptr < artis::common::Trace < Time > >
-artis::common::Trace < Time >::_instance = nullptr;
-
-template < class Time >
-std::once_flag artis::common::Trace < Time >::_flag;
-
 #endif
@@ -0,0 +1,382 @@
+/**
+ * @file common/utils/TraceBuffer.hpp
+ * @author The ARTIS Development Team
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * ARTIS - the multimodeling and simulation environment
+ * This file is a part of the ARTIS environment
+ *
+ * Copyright (C) 2013-2018 ULCO http://www.univ-littoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMMON_UTILS_TRACE_BUFFER
+#define COMMON_UTILS_TRACE_BUFFER 1
+
+#include <artis-star/common/utils/Trace.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace artis { namespace common {
+
+/**
+ * Binary trace element of fixed size: the comment of the text trace is
+ * rebuilt offline from the format and the fields, the formats are defined
+ * by the models. The fields after the FIELD_NUMBER first ones follow in
+ * CONTINUATION records.
+ */
+template < class Time >
+struct TraceRecord
+{
+    static const unsigned int FIELD_NUMBER = 6;
+    static const uint16_t CONTINUATION = 0xffff;
+
+    typename Time::type time;
+    uint32_t            model;
+    uint8_t             type;
+    uint8_t             field_number;
+    uint16_t            format;
+    double              fields[FIELD_NUMBER];
+};
+
+/**
+ * Binary trace of the models. Each thread writes its records in its own
+ * ring buffer without lock, a writer thread copies the rings in one file
+ * by thread: path.0, path.1... The models are identified by their paths
+ * (:root:cc_21:crane for instance), written in path.names when the trace
+ * is closed. The models are traced only if they are enabled by their
+ * paths, a disabled model costs a load.
+ */
+template < class Time >
+class TraceBuffer
+{
+public:
+    typedef TraceRecord < Time > record_type;
+
+    // records of a thread waiting for the writer, a power of 2
+    static const size_t CAPACITY = 1 << 14;
+    static const uint32_t MAX_MODEL_NUMBER = 1 << 12;
+    // id of a model whose path is not known yet
+    static const uint32_t UNKNOWN_MODEL = ~0U;
+
+    static void open(const std::string& path)
+    {
+        Registry& r = registry();
+        std::lock_guard < std::mutex > lock(r.mutex);
+
+        if (r.opened.load()) {
+            return;
+        }
+        r.path = path;
+        r.file_number = 0;
+        for (Ring* ring : r.rings) {
+            ring->open(r.path, r.file_number++);
+        }
+        r.stop = false;
+        r.writer = std::thread(&TraceBuffer::write_rings);
+        r.opened.store(true, std::memory_order_release);
+    }
+
+    // the models have stopped writing
+    static void close()
+    {
+        Registry& r = registry();
+
+        {
+            std::lock_guard < std::mutex > lock(r.mutex);
+
+            if (not r.opened.load()) {
+                return;
+            }
+            r.opened.store(false, std::memory_order_release);
+            r.stop = true;
+        }
+        r.condition.notify_one();
+        r.writer.join();
+
+        std::lock_guard < std::mutex > lock(r.mutex);
+        FILE* file = std::fopen((r.path + ".names").c_str(), "w");
+
+        for (Ring* ring : r.rings) {
+            ring->drain();
+            ring->close();
+        }
+        if (file) {
+            for (const std::string& path : r.paths) {
+                std::fprintf(file, "%s\n", path.c_str());
+            }
+            std::fclose(file);
+        }
+    }
+
+    // the model with this path is traced, all the models if path is empty
+    static void enable(const std::string& path = std::string())
+    {
+        Registry& r = registry();
+        std::lock_guard < std::mutex > lock(r.mutex);
+
+        if (path.empty()) {
+            r.all.store(true, std::memory_order_relaxed);
+        } else {
+            r.enabled_paths.insert(path);
+
+            auto it = r.ids.find(path);
+
+            if (it != r.ids.end()) {
+                r.flags[it->second].store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    static void disable()
+    {
+        Registry& r = registry();
+        std::lock_guard < std::mutex > lock(r.mutex);
+
+        r.all.store(false, std::memory_order_relaxed);
+        r.enabled_paths.clear();
+        for (uint32_t i = 0; i < MAX_MODEL_NUMBER; ++i) {
+            r.flags[i].store(false, std::memory_order_relaxed);
+        }
+    }
+
+    static bool enabled(uint32_t model)
+    {
+        const Registry& r = registry();
+
+        return r.opened.load(std::memory_order_relaxed) and
+            (r.all.load(std::memory_order_relaxed) or
+             (model < MAX_MODEL_NUMBER and
+              r.flags[model].load(std::memory_order_relaxed)));
+    }
+
+    // id of the model with this path, the same for all the threads: the
+    // instances of a model simulated by several threads share it
+    static uint32_t model(const std::string& path)
+    {
+        Registry& r = registry();
+        std::lock_guard < std::mutex > lock(r.mutex);
+        auto it = r.ids.find(path);
+
+        if (it != r.ids.end()) {
+            return it->second;
+        }
+
+        uint32_t id = r.paths.size();
+
+        r.paths.push_back(path);
+        r.ids[path] = id;
+        if (id < MAX_MODEL_NUMBER and
+            r.enabled_paths.find(path) != r.enabled_paths.end()) {
+            r.flags[id].store(true, std::memory_order_relaxed);
+        }
+        return id;
+    }
+
+    static void write(typename Time::type time, uint32_t model,
+                      TraceType type, unsigned int format,
+                      const double* fields, size_t field_number)
+    {
+        Ring& ring = Ring::local();
+        record_type record;
+        size_t i = 0;
+
+        record.time = time;
+        record.model = model;
+        record.type = type;
+        record.format = format;
+        do {
+            record.field_number = std::min(field_number - i,
+                                           (size_t)record_type::FIELD_NUMBER);
+            std::copy(fields + i, fields + i + record.field_number,
+                      record.fields);
+            std::fill(record.fields + record.field_number,
+                      record.fields + record_type::FIELD_NUMBER, 0.);
+            ring.push(record);
+            i += record.field_number;
+            record.type = NONE;
+            record.format = record_type::CONTINUATION;
+        } while (i < field_number);
+    }
+
+private:
+    // single producer (its thread), single consumer (the writer)
+    class Ring
+    {
+    public:
+        Ring() : _records(new record_type[CAPACITY]), _head(0), _tail(0),
+                 _file(nullptr)
+        { }
+
+        ~Ring()
+        {
+            Registry& r = registry();
+            std::lock_guard < std::mutex > lock(r.mutex);
+
+            drain();
+            close();
+            r.rings.erase(std::find(r.rings.begin(), r.rings.end(), this));
+        }
+
+        static Ring& local()
+        {
+            static thread_local std::unique_ptr < Ring > ring;
+
+            if (not ring) {
+                Registry& r = registry();
+
+                ring.reset(new Ring);
+
+                std::lock_guard < std::mutex > lock(r.mutex);
+
+                if (r.opened.load()) {
+                    ring->open(r.path, r.file_number++);
+                }
+                r.rings.push_back(ring.get());
+            }
+            return *ring;
+        }
+
+        void push(const record_type& record)
+        {
+            size_t head = _head.load(std::memory_order_relaxed);
+
+            while (head - _tail.load(std::memory_order_acquire) == CAPACITY) {
+                registry().condition.notify_one();
+                std::this_thread::yield();
+            }
+            _records[head & (CAPACITY - 1)] = record;
+            _head.store(head + 1, std::memory_order_release);
+        }
+
+        // the mutex of the registry is locked
+        void drain()
+        {
+            size_t tail = _tail.load(std::memory_order_relaxed);
+            size_t head = _head.load(std::memory_order_acquire);
+
+            while (tail != head) {
+                size_t n = std::min(head - tail,
+                                    CAPACITY - (tail & (CAPACITY - 1)));
+
+                if (_file) {
+                    std::fwrite(&_records[tail & (CAPACITY - 1)],
+                                sizeof(record_type), n, _file);
+                }
+                tail += n;
+            }
+            _tail.store(tail, std::memory_order_release);
+        }
+
+        void open(const std::string& path, unsigned int index)
+        {
+            close();
+            _file = std::fopen((path + "." + std::to_string(index)).c_str(),
+                               "wb");
+        }
+
+        void close()
+        {
+            if (_file) {
+                std::fclose(_file);
+                _file = nullptr;
+            }
+        }
+
+    private:
+        std::unique_ptr < record_type[] > _records;
+        std::atomic < size_t >            _head;
+        std::atomic < size_t >            _tail;
+        FILE*                             _file;
+    };
+
+    struct Registry
+    {
+        Registry() : file_number(0), stop(false), opened(false), all(false)
+        {
+            for (uint32_t i = 0; i < MAX_MODEL_NUMBER; ++i) {
+                flags[i].store(false, std::memory_order_relaxed);
+            }
+        }
+
+        // the trace has not been closed: the records still in the rings
+        // are lost
+        ~Registry()
+        {
+            if (writer.joinable()) {
+                {
+                    std::lock_guard < std::mutex > lock(mutex);
+
+                    stop = true;
+                }
+                condition.notify_one();
+                writer.join();
+            }
+        }
+
+        std::mutex                          mutex;
+        std::condition_variable             condition;
+        std::vector < Ring* >               rings;
+        std::string                         path;
+        unsigned int                        file_number;
+        std::thread                         writer;
+        bool                                stop;
+        std::vector < std::string >         paths;
+        std::map < std::string, uint32_t >  ids;
+        std::set < std::string >            enabled_paths;
+        std::atomic < bool >                opened;
+        std::atomic < bool >                all;
+        std::atomic < bool >                flags[MAX_MODEL_NUMBER];
+    };
+
+    static Registry& registry()
+    {
+        static Registry instance;
+
+        return instance;
+    }
+
+    // the writer thread, woken up by the full rings
+    static void write_rings()
+    {
+        Registry& r = registry();
+        std::unique_lock < std::mutex > lock(r.mutex);
+
+        while (not r.stop) {
+            for (Ring* ring : r.rings) {
+                ring->drain();
+            }
+            r.condition.wait_for(lock, std::chrono::milliseconds(10));
+        }
+    }
+};
+
+} } // namespace artis common
+
+#endif
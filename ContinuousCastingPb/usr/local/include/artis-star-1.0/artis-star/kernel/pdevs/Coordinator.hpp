@@ -30,41 +30,96 @@
 #include <artis-star/common/Coordinator.hpp>
 #include <artis-star/common/Parameters.hpp>
 #include <artis-star/common/Scheduler.hpp>
+#include <artis-star/common/utils/Multithreading.hpp>
 #include <artis-star/common/utils/String.hpp>
 #include <artis-star/common/utils/Trace.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 namespace artis { namespace pdevs {
 
+/**
+ * Scheduler: event table of the children, SchedulerType or
+ * IndexedSchedulerType (contiguous, cheaper put() and get_current_time())
+ */
 template < class Time,
            class GraphManager,
            class Parameters = common::NoParameters,
-           class GraphParameters = common::NoParameters >
+           class GraphParameters = common::NoParameters,
+           class Scheduler = common::SchedulerType >
 class Coordinator : public common::Coordinator < Time >
 {
     typedef Coordinator < Time, GraphManager,
-                          Parameters, GraphParameters > type;
+                          Parameters, GraphParameters, Scheduler > type;
+
+    // transitions of a slice of the receivers
+    struct Slice : common::WorkerPool::Task
+    {
+        type*                          coordinator;
+        const common::Models < Time >* models;
+        size_t                         begin;
+        size_t                         end;
+        typename Time::type            t;
+
+        void run()
+        {
+            coordinator->transition_slice(*models, begin, end, t);
+            coordinator->_remaining_slices.fetch_sub(
+                1, std::memory_order_acq_rel);
+        }
+    };
 
 public:
     typedef Parameters parameters_type;
     typedef GraphParameters graph_parameters_type;
+    typedef Scheduler scheduler_type;
 
     Coordinator(const std::string& name,
                 const Parameters& parameters,
                 const GraphParameters& graph_parameters) :
         common::Model < Time >(name),
         common::Coordinator < Time >(name),
-        _graph_manager(this, parameters, graph_parameters)
+        _graph_manager(this, parameters, graph_parameters),
+        _epoch(0), _zero_time_cascades(false), _parallel_threshold(0),
+        _pool(nullptr), _remaining_slices(0)
     { }
 
     virtual ~Coordinator()
     { }
 
-    const common::GraphManager < Time >& get_graph_manager() const
+    const GraphManager& get_graph_manager() const
     { return _graph_manager; }
 
+/*******************************************************************
+ * the transitions of the receivers of a step are independent: from
+ * threshold receivers (0: never), they are made by slices on the
+ * workers of the pool and the event table is updated afterwards, in
+ * the order of the sequential steps. The dynamics must not share any
+ * mutable state.
+ *******************************************************************/
+    void set_parallel_transitions(
+        unsigned int threshold,
+        common::WorkerPool& pool = common::WorkerPool::pool())
+    {
+        _parallel_threshold = threshold;
+        _pool = &pool;
+    }
+
+/*******************************************************************
+ * the root coordinator makes the steps of a zero-time cascade itself,
+ * without going back to the root coordinator of the run: the views
+ * and the stop predicate of the run only see the last step of each
+ * cascade. Off by default, a nested coordinator is stepped by its
+ * parent anyway.
+ *******************************************************************/
+    void set_zero_time_cascades(bool cascades)
+    { _zero_time_cascades = cascades; }
+
     virtual std::string to_string(int level) const
     {
         std::ostringstream ss;
@@ -89,9 +144,10 @@ public:
 
         assert(_graph_manager.children().size() > 0);
 
-        for (auto & child : _graph_manager.children()) {
-            _event_table.init(child->start(t), child);
-        }
+        _event_table.clear();
+        _receivers.clear();
+        type::clear_bag();
+        start_children(t);
         type::_tl = t;
         type::_tn = _event_table.get_current_time();
 
@@ -130,8 +186,9 @@ public:
 
         assert(t == type::_tn);
 
-        common::Models < Time > IMM =
-            _event_table.get_current_models(t);
+        common::Models < Time >& IMM = _imminents;
+
+        _event_table.get_current_models(t, IMM);
 
 #ifdef WITH_TRACE
         common::Trace < Time >::trace()
@@ -181,28 +238,19 @@ public:
 
         assert(t >= type::_tl and t <= type::_tn);
 
-        common::Models < Time > receivers =
-            _event_table.get_current_models(t);
-
-        add_models_with_inputs(receivers);
-
-#ifdef WITH_TRACE
-        common::Trace < Time >::trace()
-            << common::TraceElement < Time >(type::get_name(), t,
-                                             common::S_MESSAGE)
-            << ": receivers = " << receivers.to_string();
-        common::Trace < Time >::trace().flush();
-#endif
-
-        for (auto & model : receivers) {
-            _event_table.put(model->transition(t), model);
-        }
-
-        update_event_table(t);
+        transition_children(t);
         type::_tl = t;
         type::_tn = _event_table.get_current_time();
         type::clear_bag();
 
+        // zero-time cascade: the root makes the next steps at t itself
+        while (_zero_time_cascades and type::_tn == t and
+               type::get_coordinator() == nullptr) {
+            output(t);
+            transition_children(t);
+            type::_tn = _event_table.get_current_time();
+        }
+
 #ifdef WITH_TRACE
         common::Trace < Time >::trace()
             << common::TraceElement < Time >(type::get_name(), t,
@@ -276,6 +324,29 @@ public:
         return type::_tn;
     }
 
+    virtual void dispatch_event(common::Model < Time >* child,
+                                unsigned int port_index,
+                                const common::Value& value,
+                                const typename Time::type& t)
+    { _graph_manager.dispatch_event(child, port_index, value, t); }
+
+    // all the events emitted by a child at t are dispatched
+    virtual void end_dispatch(const typename Time::type& t)
+    {
+        update_event_table(t);
+        type::_tn = _event_table.get_current_time();
+
+#ifdef WITH_TRACE
+        common::Trace < Time >::trace()
+            << common::TraceElement < Time >(type::get_name(), t,
+                                             common::Y_MESSAGE)
+            << ": AFTER => " << "tl = " << type::_tl << " ; tn = " << type::_tn
+            << " ; " << _event_table.to_string();
+        common::Trace < Time >::trace().flush();
+#endif
+
+    }
+
     common::Value observe(const typename Time::type& /* t */,
                           unsigned int /* index */) const
     {
@@ -283,31 +354,188 @@ public:
         return common::Value();
     }
 
+/*******************************************************************
+ * between two steps, the bags are empty: the event table is copied
+ * with its structure because the order of the imminent models with
+ * the same tn depends on it
+ *******************************************************************/
+    void save(common::Snapshot < Time >& snapshot) const
+    {
+        typedef typename common::Snapshot < Time >::template Copy <
+            Scheduler > Copy;
+        typename common::Snapshot < Time >::Entry& entry = snapshot.write();
+
+        entry.tl = type::_tl;
+        entry.tn = type::_tn;
+        if (entry.state) {
+            static_cast < Copy& >(*entry.state).value = _event_table;
+        } else {
+            entry.state.reset(new Copy(_event_table));
+        }
+
+        const Scheduler& copy =
+            static_cast < const Copy& >(*entry.state).value;
+
+        // the top of a heap copy may be chosen again among the roots
+        if (not copy.empty() and
+            copy.get_current_model() != _event_table.get_current_model()) {
+            snapshot.invalidate();
+        }
+        for (auto & child : _graph_manager.children()) {
+            child->save(snapshot);
+        }
+    }
+
+    void restore(const common::Snapshot < Time >& snapshot)
+    {
+        typedef typename common::Snapshot < Time >::template Copy <
+            Scheduler > Copy;
+        const typename common::Snapshot < Time >::Entry& entry =
+            snapshot.read();
+
+        type::clear_bag();
+        _receivers.clear();
+        type::_tl = entry.tl;
+        type::_tn = entry.tn;
+        _event_table.restore(static_cast < const Copy& >(*entry.state).value);
+        for (auto & child : _graph_manager.children()) {
+            child->restore(snapshot);
+        }
+    }
+
+    virtual void add_receiver(common::Model < Time >* child)
+    { _receivers.push_back(child); }
+
+    // only the children which received inputs since the last transition:
+    // the models of the step are marked with its epoch (by child index)
     void add_models_with_inputs(
         common::Models < Time >& receivers)
     {
-        for (auto & model : _graph_manager.children()) {
-            if (model->event_number() > 0) {
-                if (std::find(receivers.begin(), receivers.end(),
-                              model) == receivers.end()) {
-                    receivers.push_back(model);
-                }
+        ++_epoch;
+        _marks.resize(_graph_manager.children().size(), 0);
+        for (auto & model : receivers) {
+            _marks[model->get_child_index()] = _epoch;
+        }
+        for (auto & model : _receivers) {
+            unsigned long& mark = _marks[model->get_child_index()];
+
+            if (mark != _epoch) {
+                mark = _epoch;
+                receivers.push_back(model);
+            }
+        }
+    }
+
+    // in the order of the children (the ranks of the event table)
+    virtual void start_children(const typename Time::type& t)
+    {
+        for (auto & child : _graph_manager.children()) {
+            _event_table.init(child->start(t), child);
+        }
+    }
+
+    // imminent models and receivers
+    virtual void transition_children(const typename Time::type& t)
+    {
+        common::Models < Time >& receivers = _imminents;
+
+        _event_table.get_current_models(t, receivers);
+        add_models_with_inputs(receivers);
+
+#ifdef WITH_TRACE
+        common::Trace < Time >::trace()
+            << common::TraceElement < Time >(type::get_name(), t,
+                                             common::S_MESSAGE)
+            << ": receivers = " << receivers.to_string();
+        common::Trace < Time >::trace().flush();
+#endif
+
+        if (_parallel_threshold > 0 and
+            receivers.size() >= _parallel_threshold) {
+            transition_in_parallel(receivers, t);
+            for (size_t i = 0; i < receivers.size(); ++i) {
+                _event_table.put(_receiver_tns[i], receivers[i]);
+            }
+        } else {
+            for (auto & model : receivers) {
+                _event_table.put(model->transition(t), model);
             }
         }
+        update_event_table(t);
+        _receivers.clear();
     }
 
     void update_event_table(typename Time::type t)
     {
-        for (auto & model : _graph_manager.children()) {
+        for (auto & model : _receivers) {
             if (model->event_number() > 0) {
                 _event_table.put(t, model);
             }
         }
     }
 
+private:
+    // the next times of the receivers are written in _receiver_tns
+    void transition_in_parallel(const common::Models < Time >& receivers,
+                                const typename Time::type& t)
+    {
+        size_t slice_number = std::min((size_t)_pool->size() + 1,
+                                       receivers.size());
+        size_t begin = 0;
+
+        _receiver_tns.resize(receivers.size());
+        _slices.resize(slice_number);
+        _remaining_slices.store(slice_number - 1, std::memory_order_relaxed);
+        for (size_t i = 0; i < slice_number; ++i) {
+            Slice& slice = _slices[i];
+
+            slice.coordinator = this;
+            slice.models = &receivers;
+            slice.begin = begin;
+            slice.end = begin + (receivers.size() - begin) /
+                (slice_number - i);
+            slice.t = t;
+            begin = slice.end;
+        }
+        // the first slice is made by the calling thread
+        for (size_t i = 1; i < slice_number; ++i) {
+            _pool->submit(&_slices[i]);
+        }
+        transition_slice(receivers, _slices[0].begin, _slices[0].end, t);
+        while (_remaining_slices.load(std::memory_order_acquire) > 0) {
+            if (not _pool->help()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void transition_slice(const common::Models < Time >& models,
+                          size_t begin, size_t end,
+                          const typename Time::type& t)
+    {
+        for (size_t i = begin; i < end; ++i) {
+            _receiver_tns[i] = models[i]->transition(t);
+        }
+    }
+
 protected:
-    GraphManager          _graph_manager;
-    common::SchedulerType _event_table;
+    GraphManager            _graph_manager;
+    Scheduler               _event_table;
+    // children with inputs since the last transition, in order of arrival
+    common::Models < Time > _receivers;
+    // buffer of the imminent models and receivers of a step
+    common::Models < Time > _imminents;
+    // epoch of the last step of each child (see add_models_with_inputs)
+    unsigned long                 _epoch;
+    std::vector < unsigned long > _marks;
+
+private:
+    bool                                _zero_time_cascades;
+    unsigned int                        _parallel_threshold;
+    common::WorkerPool*                 _pool;
+    std::vector < Slice >               _slices;
+    std::vector < typename Time::type > _receiver_tns;
+    std::atomic < size_t >              _remaining_slices;
 };
 
 } } // namespace artis pdevs
@@ -30,8 +30,12 @@
 #include <artis-star/common/Bag.hpp>
 #include <artis-star/common/ExternalEvent.hpp>
 #include <artis-star/common/Parameters.hpp>
+#include <artis-star/common/Sink.hpp>
+#include <artis-star/common/TypedPort.hpp>
+#include <artis-star/common/utils/TraceBuffer.hpp>
 #include <artis-star/kernel/pdevs/Simulator.hpp>
 
+#include <initializer_list>
 #include <string>
 #include <vector>
 
@@ -53,7 +57,8 @@ public:
 
     Dynamics(const std::string& name,
              const Context < Time, Dyn, Parameters >& context) :
-        _name(name), _simulator(context.simulator())
+        _name(name), _simulator(context.simulator()),
+        _trace_model(common::TraceBuffer < Time >::UNKNOWN_MODEL)
     { }
 
     virtual ~Dynamics()
@@ -82,6 +87,22 @@ public:
         typename Time::type /* time */) const
     { return common::Bag < Time >(); }
 
+    // outputs emitted into the inputs of the receivers, by default the
+    // events of the bag of lambda(time)
+    virtual void lambda(typename Time::type time,
+                        common::Sink < Time >& sink) const
+    {
+        common::Bag < Time > bag = lambda(time);
+
+        for (auto & event : bag) {
+            sink.emit(event.get_port_index(), event.data());
+        }
+    }
+
+    // called by the simulator whichever lambda() is defined
+    void emit(typename Time::type time, common::Sink < Time >& sink) const
+    { lambda(time, sink); }
+
     virtual common::Value observe(const typename Time::type& /* t */,
                                   unsigned int /* index */) const
     { return common::Value(); }
@@ -89,6 +110,28 @@ public:
     const std::string& get_name() const
     { return _name; }
 
+    // the binary trace of the model is enabled by its path at runtime
+    bool traced() const
+    { return common::TraceBuffer < Time >::enabled(trace_model()); }
+
+    // the comment of the element is rebuilt from the format and the fields
+    // by the decoder of the trace
+    void trace(typename Time::type t, common::TraceType type,
+               unsigned int format,
+               std::initializer_list < double > fields = { }) const
+    {
+        common::TraceBuffer < Time >::write(t, trace_model(), type, format,
+                                            fields.begin(), fields.size());
+    }
+
+    template < class Fields >
+    void trace(typename Time::type t, common::TraceType type,
+               unsigned int format, const Fields& fields) const
+    {
+        common::TraceBuffer < Time >::write(t, trace_model(), type, format,
+                                            fields.data(), fields.size());
+    }
+
     void input_port(common::Port p)
     {
         _simulator->add_in_port(p);
@@ -102,6 +145,18 @@ public:
         }
     }
 
+    template < class T >
+    void input_port(const common::InPort < T >& port, const std::string& name)
+    {
+        _simulator->add_in_port({ port.index, name });
+        _simulator->template typed_input < T >(port.index);
+    }
+
+    // events received on a typed port since the last transition
+    template < class T >
+    const std::vector < T >& get_inputs(const common::InPort < T >& port) const
+    { return _simulator->template typed_input < T >(port.index).values(); }
+
     void observable(Observable observable)
     {
         _observables[observable.index] = observable.name;
@@ -135,10 +190,29 @@ public:
         }
     }
 
+    template < class T >
+    void output_port(const common::OutPort < T >& port,
+                     const std::string& name)
+    {
+        _simulator->add_out_port({ port.index, name });
+        _simulator->template typed_output < T >(port.index);
+    }
+
 private:
-    std::string _name;
-    Simulator*  _simulator;
-    Observables _observables;
+    // the path of the model is only known once it is added to its parent
+    uint32_t trace_model() const
+    {
+        if (_trace_model == common::TraceBuffer < Time >::UNKNOWN_MODEL) {
+            _trace_model = common::TraceBuffer < Time >::model(
+                _simulator->path());
+        }
+        return _trace_model;
+    }
+
+    std::string      _name;
+    Simulator*       _simulator;
+    Observables      _observables;
+    mutable uint32_t _trace_model;
 };
 
 } } // namespace artis pdevs
@@ -34,7 +34,12 @@
 #include <artis-star/common/Parameters.hpp>
 #include <artis-star/common/utils/String.hpp>
 
+#include <algorithm>
+#include <cassert>
 #include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 namespace artis { namespace pdevs {
 
@@ -65,10 +70,35 @@ public:
         }
     };
 
+    template < class T >
+    struct TypedInPort
+    {
+        common::Model < Time >* model;
+        common::InPort < T >    port;
+    };
+
+    template < class T >
+    struct TypedOutPort
+    {
+        common::Model < Time >* model;
+        common::OutPort < T >   port;
+        type*                   graph_manager;
+
+        template < class U >
+        void operator>>(const TypedInPort < U >& dst)
+        {
+            static_assert(std::is_same < T, U >::value,
+                          "the coupled ports carry different types");
+
+            graph_manager->add_link(model, port, dst.model, dst.port);
+        }
+    };
+
     GraphManager(common::Coordinator < Time >* coordinator,
                  const Parameters& /* parameters */,
                  const GraphParameters& /* graph_parameters */) :
-        common::GraphManager < Time >(coordinator)
+        common::GraphManager < Time >(coordinator), _flat(false),
+        _compiled(false)
     { }
 
     virtual ~GraphManager()
@@ -80,27 +110,59 @@ public:
     ModelPort out(ModelPort p)
     { p.graph_manager = this; return p; }
 
-    void dispatch_events(common::Bag < Time > bag,
+    template < class T >
+    TypedInPort < T > in(common::Model < Time >* model,
+                         const common::InPort < T >& port)
+    { return TypedInPort < T >{ model, port }; }
+
+    template < class T >
+    TypedOutPort < T > out(common::Model < Time >* model,
+                           const common::OutPort < T >& port)
+    { return TypedOutPort < T >{ model, port, this }; }
+
+    // the events do not go through the coupled model
+    template < class T >
+    void add_link(common::Model < Time >* src_model,
+                  const common::OutPort < T >& src_port,
+                  common::Model < Time >* dst_model,
+                  const common::InPort < T >& dst_port)
+    {
+        assert(src_model->get_parent() ==
+               common::GraphManager < Time >::_coordinator and
+               dst_model->get_parent() ==
+               common::GraphManager < Time >::_coordinator);
+
+        src_model->template typed_output < T >(src_port.index).add_receiver(
+            &dst_model->template typed_input < T >(dst_port.index));
+    }
+
+    void dispatch_events(const common::Bag < Time >& bag,
                          typename Time::type t)
     {
         for (auto & ymsg : bag) {
-            typename common::Links < Time >::Result result_model =
-                _link_list.find(ymsg.get_model(),
-                                ymsg.get_port_index());
-
-            for (typename common::Links < Time >::
-                     const_iterator it = result_model.first;
-                     it != result_model.second; ++it) {
-                // event on output port of coupled Model
-                if (it->second.get_model() ==
-                    common::GraphManager < Time >::_coordinator) {
-                    dispatch_events_to_parent(it->second, ymsg.data(),
-                                              t);
-                } else { // event on input port of internal model
-                    it->second.get_model()->post_event(
-                        t, common::ExternalEvent < Time >(
-                            it->second, ymsg.data()));
-                }
+            dispatch_event(ymsg.get_model(), ymsg.get_port_index(),
+                           ymsg.data(), t);
+        }
+    }
+
+    void dispatch_event(const common::Model < Time >* model,
+                        unsigned int port_index, const common::Value& data,
+                        typename Time::type t)
+    {
+        assert(model->get_coordinator() ==
+               common::GraphManager < Time >::_coordinator);
+
+        Route route = find(model->get_child_index(), port_index);
+
+        for (const common::Node < Time >* it = route.first;
+             it != route.second; ++it) {
+            // event on output port of coupled Model
+            if (it->get_model() ==
+                common::GraphManager < Time >::_coordinator) {
+                dispatch_events_to_parent(*it, data, t);
+            } else { // event on input port of internal model
+                it->get_model()->post_event(
+                    t, common::ExternalEvent < Time >(*it, data));
             }
         }
     }
@@ -109,14 +171,14 @@ public:
                                            const common::Value& content,
                                            typename Time::type t)
     {
-        common::Bag < Time > ymessages;
-
-        ymessages.push_back(
+        // the bag is only used by the parent during the call
+        _parent_events.clear();
+        _parent_events.push_back(
             common::ExternalEvent <Time >(node, content));
 
         dynamic_cast < common::Coordinator < Time >* >(
-            common::GraphManager < Time >::_coordinator->get_parent())
-            ->dispatch_events(ymessages, t);
+            common::GraphManager < Time >::_coordinator->get_coordinator())
+            ->dispatch_events(_parent_events, t);
     }
 
     bool exist_link(common::Model < Time >* src_model,
@@ -131,16 +193,44 @@ public:
     void post_event(typename Time::type t,
                     const common::ExternalEvent < Time >& event)
     {
-        typename common::Links < Time >::Result result =
-            _link_list.find(common::GraphManager < Time >::_coordinator,
-                            event.get_port_index());
+        // the input ports of the coupled model follow the children
+        Route route = find(common::GraphManager < Time >::_children.size(),
+                           event.get_port_index());
+
+        for (const common::Node < Time >* it = route.first;
+             it != route.second; ++it) {
+            it->get_model()->post_event(
+                t, common::ExternalEvent < Time >(*it, event.data()));
+        }
+    }
+
+    virtual const common::Links < Time >* links() const
+    { return &_link_list; }
+
+/*******************************************************************
+ * closure under coupling: the atomic models of the hierarchy become
+ * the children of this graph manager, in depth-first order, and the
+ * links go from atomic model to atomic model through the ports of the
+ * nested coupled models. The nested coordinators are only kept for the
+ * structure (paths, submodels of the observers), they are no longer
+ * simulated. Must be called once the hierarchy is built: the links
+ * added after are rejected.
+ *******************************************************************/
+    void flatten()
+    {
+        common::Models < Time > models;
+        Path path;
 
-        for (typename common::Links < Time >::const_iterator it_r =
-                 result.first; it_r != result.second; ++it_r) {
-                 it_r->second.get_model()->post_event(
-                     t, common::ExternalEvent < Time >(it_r->second,
-                                                       event.data()));
+        _flat_links.clear();
+        flatten(this, path, models);
+        common::GraphManager < Time >::_children = models;
+        for (size_t i = 0; i < models.size(); ++i) {
+            models[i]->set_child_index(i);
+            models[i]->set_coordinator(
+                common::GraphManager < Time >::_coordinator);
         }
+        _flat = true;
+        _compiled = false;
     }
 
     virtual std::string to_string(int level) const
@@ -161,6 +251,12 @@ private:
                   common::Model < Time >* dst_model,
                   unsigned int dst_port_index)
     {
+        // compile() only reads the links computed by flatten()
+        if (_flat) {
+            throw std::logic_error(
+                "GraphManager: link added to the flattened model " +
+                common::GraphManager < Time >::_coordinator->path());
+        }
         assert((src_model != common::GraphManager < Time >::_coordinator and
                 dst_model != common::GraphManager < Time >::_coordinator and
                 src_model->exist_out_port(src_port_index) and
@@ -175,9 +271,189 @@ private:
                 dst_model->exist_out_port(dst_port_index)));
 
         _link_list.add(src_model, src_port_index, dst_model, dst_port_index);
+        _compiled = false;
+    }
+
+    typedef std::vector < const common::GraphManager < Time >* > Path;
+    typedef std::pair < common::Node < Time >,
+                        common::Node < Time > > Link;
+
+    static const common::GraphManager < Time >* graph_manager(
+        const common::Model < Time >* model)
+    {
+        return &dynamic_cast < const common::Coordinator < Time >* >(
+            model)->get_graph_manager();
     }
 
-    common::Links < Time > _link_list;
+    static const common::Links < Time >& links(
+        const common::GraphManager < Time >* graph_manager)
+    {
+        const common::Links < Time >* links = graph_manager->links();
+
+        if (links == nullptr) {
+            throw std::logic_error(
+                "GraphManager: the links of " +
+                graph_manager->get_coordinator()->path() +
+                " are not kept, it cannot be flattened");
+        }
+        return *links;
+    }
+
+    // path: graph managers from the root to graph_manager
+    void flatten(const common::GraphManager < Time >* graph_manager,
+                 Path& path, common::Models < Time >& models)
+    {
+        path.push_back(graph_manager);
+        for (auto & child : graph_manager->children()) {
+            if (child->is_atomic()) {
+                models.push_back(child);
+            } else {
+                flatten(type::graph_manager(child), path, models);
+            }
+        }
+        // the links of a source keep their order
+        for (auto & link : links(graph_manager)) {
+            const common::Model < Time >* source = link.first.get_model();
+
+            if (source->is_atomic() or
+                source == common::GraphManager < Time >::_coordinator) {
+                std::vector < common::Node < Time > > destinations;
+
+                route(path, link.second, destinations);
+                for (auto & destination : destinations) {
+                    _flat_links.push_back(Link(link.first, destination));
+                }
+            }
+        }
+        path.pop_back();
+    }
+
+    // atomic destinations of node in path.back()
+    void route(Path path, const common::Node < Time >& node,
+               std::vector < common::Node < Time > >& destinations) const
+    {
+        common::Model < Time >* model = node.get_model();
+
+        if (model->is_atomic() or
+            (model == path.back()->get_coordinator() and path.size() == 1)) {
+            destinations.push_back(node);
+            return;
+        }
+        if (model == path.back()->get_coordinator()) {
+            // output port of a nested coupled model
+            path.pop_back();
+        } else {
+            // input port of a nested coupled model
+            path.push_back(type::graph_manager(model));
+        }
+
+        typename common::Links < Time >::Result result =
+            links(path.back()).find(model, node.get_port_index());
+
+        for (auto it = result.first; it != result.second; ++it) {
+            route(path, it->second, destinations);
+        }
+    }
+
+    // destinations of a port, contiguous
+    typedef std::pair < const common::Node < Time >*,
+                        const common::Node < Time >* > Route;
+
+    // source: rank of a child or number of children for the coupled model
+    Route find(unsigned int source, unsigned int port_index)
+    {
+        if (not _compiled) {
+            compile();
+        }
+
+        size_t port = _ports[source] + port_index;
+        const common::Node < Time >* destinations = _destinations.data();
+
+        if (port >= _ports[source + 1]) {
+            return Route(nullptr, nullptr);
+        }
+        return Route(destinations + _offsets[port],
+                     destinations + _offsets[port + 1]);
+    }
+
+/*******************************************************************
+ * the links are compiled after the construction of the graph into
+ * a table indexed by (source, port): the ports of the source s are
+ * [_ports[s], _ports[s + 1]), the destinations of the port p are
+ * [_offsets[p], _offsets[p + 1]) and keep the order of the links
+ *******************************************************************/
+    void compile()
+    {
+        if (_flat) {
+            compile(_flat_links);
+        } else {
+            compile(_link_list);
+        }
+    }
+
+    template < class LinkList >
+    void compile(const LinkList& link_list)
+    {
+        const common::Models < Time >& children =
+            common::GraphManager < Time >::_children;
+        size_t source_number = children.size() + 1;
+        std::vector < size_t > port_numbers(source_number, 0);
+        std::vector < std::pair < size_t,
+                                  const common::Node < Time >* > > links;
+
+        auto source = [&](const common::Model < Time >* model) {
+            if (model == common::GraphManager < Time >::_coordinator) {
+                return children.size();
+            }
+            assert(children[model->get_child_index()] == model);
+
+            return (size_t)model->get_child_index();
+        };
+
+        for (auto & link : link_list) {
+            size_t& number = port_numbers[source(link.first.get_model())];
+
+            number = std::max < size_t >(number,
+                                         link.first.get_port_index() + 1);
+        }
+        _ports.assign(source_number + 1, 0);
+        for (size_t s = 0; s < source_number; ++s) {
+            _ports[s + 1] = _ports[s] + port_numbers[s];
+        }
+        for (auto & link : link_list) {
+            links.push_back(std::make_pair(
+                                _ports[source(link.first.get_model())] +
+                                link.first.get_port_index(), &link.second));
+        }
+        std::stable_sort(links.begin(), links.end(),
+                         [](const std::pair < size_t,
+                                const common::Node < Time >* >& a,
+                            const std::pair < size_t,
+                                const common::Node < Time >* >& b) {
+                             return a.first < b.first;
+                         });
+        _offsets.assign(_ports.back() + 1, 0);
+        _destinations.clear();
+        for (auto & link : links) {
+            ++_offsets[link.first + 1];
+            _destinations.push_back(*link.second);
+        }
+        for (size_t port = 1; port < _offsets.size(); ++port) {
+            _offsets[port] += _offsets[port - 1];
+        }
+        _compiled = true;
+    }
+
+    common::Links < Time >                _link_list;
+    // links between the atomic models once flattened
+    bool                                  _flat;
+    std::vector < Link >                  _flat_links;
+
+    bool                                  _compiled;
+    std::vector < size_t >                _ports;
+    std::vector < size_t >                _offsets;
+    std::vector < common::Node < Time > > _destinations;
+    common::Bag < Time >                  _parent_events;
 };
 
 } } // namespace artis pdevs
@@ -30,6 +30,7 @@
 #include <artis-star/common/Coordinator.hpp>
 #include <artis-star/common/Parameters.hpp>
 #include <artis-star/common/Simulator.hpp>
+#include <artis-star/common/Sink.hpp>
 #include <artis-star/common/utils/String.hpp>
 #include <artis-star/common/utils/Trace.hpp>
 
@@ -82,6 +83,9 @@ public :
     ~Simulator()
     { }
 
+    const Dynamics& dynamics() const
+    { return _dynamics; }
+
     virtual std::string to_string(int level) const
     {
         std::ostringstream ss;
@@ -108,6 +112,7 @@ public :
         common::Trace < Time >::trace().flush();
 #endif
 
+        type::clear_bag();
         type::_tl = t;
         type::_tn =
             type::_tl + _dynamics.start(t);
@@ -148,14 +153,14 @@ public :
 #endif
 
         if(t == type::_tn) {
-            common::Bag < Time > bag = _dynamics.lambda(t);
-
-            if (not bag.empty()) {
-                for (auto & event : bag) {
-                    event.set_model(this);
-                }
+            common::Coordinator < Time >* parent =
                 dynamic_cast < common::Coordinator < Time >* >(
-                    type::get_parent())->dispatch_events(bag, t);
+                    type::get_coordinator());
+            common::Sink < Time > sink(this, parent, t);
+
+            _dynamics.emit(t, sink);
+            if (sink.size() > 0) {
+                parent->end_dispatch(t);
             }
         }
 
@@ -246,6 +251,37 @@ public :
         return type::_tn;
     }
 
+/*************************************************
+ * the dynamics must be copyable
+ *************************************************/
+    void save(common::Snapshot < Time >& snapshot) const
+    {
+        typedef typename common::Snapshot < Time >::template Copy <
+            Dynamics > Copy;
+        typename common::Snapshot < Time >::Entry& entry = snapshot.write();
+
+        entry.tl = type::_tl;
+        entry.tn = type::_tn;
+        if (entry.state) {
+            static_cast < Copy& >(*entry.state).value = _dynamics;
+        } else {
+            entry.state.reset(new Copy(_dynamics));
+        }
+    }
+
+    void restore(const common::Snapshot < Time >& snapshot)
+    {
+        typedef typename common::Snapshot < Time >::template Copy <
+            Dynamics > Copy;
+        const typename common::Snapshot < Time >::Entry& entry =
+            snapshot.read();
+
+        type::clear_bag();
+        type::_tl = entry.tl;
+        type::_tn = entry.tn;
+        _dynamics = static_cast < const Copy& >(*entry.state).value;
+    }
+
 private :
     Dynamics _dynamics;
 };
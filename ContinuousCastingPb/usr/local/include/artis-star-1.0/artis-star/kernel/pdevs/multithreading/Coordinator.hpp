@@ -24,6 +24,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+
 #ifndef PDEVS_MULTITHREADING_COORDINATOR
 #define PDEVS_MULTITHREADING_COORDINATOR 1
 
@@ -31,205 +32,158 @@
 #include <artis-star/kernel/pdevs/Coordinator.hpp>
 
 #include <thread>
+#include <vector>
 
 namespace artis { namespace pdevs { namespace multithreading {
 
-template < class Time>
-struct start_message
-{
-    explicit start_message(typename Time::type t) : _t(t)
-    { }
-
-    typename Time::type _t;
-};
-
-template < class Time>
-struct transition_message
-{
-    explicit transition_message(typename Time::type t) : _t(t)
-    { }
-
-    typename Time::type _t;
-};
-
+// answer of a coupled child to its coordinator
 template < class Time >
-struct done_start_message
+struct Message
 {
-    explicit done_start_message(typename Time::type tn,
-                                common::Model < Time >* child) :
-        _tn(tn), _child(child)
-    { }
+    enum Kind { DONE_START, DONE_TRANSITION };
 
-    typename Time::type     _tn;
-    common::Model < Time >* _child;
-};
-
-template < class Time >
-struct done_transition_message
-{
-    explicit done_transition_message(typename Time::type tn,
-                                     common::Model < Time >* child) :
-        _tn(tn), _child(child)
-    { }
-
-    typename Time::type     _tn;
-    common::Model < Time >* _child;
+    Kind                    kind;
+    typename Time::type     tn;
+    common::Model < Time >* child;
 };
 
+/**
+ * P-DEVS coordinator whose coupled children (one per casting line for
+ * instance) start and make their transitions in parallel on the workers of
+ * a shared pool: each one is a task of the pool which answers in the
+ * mailbox of the coordinator. The coordinator makes the transitions of its
+ * atomic children and helps the pool while waiting for the answers, then
+ * updates its event table in the order of the children. The outputs stay
+ * sequential.
+ */
 template < class Time,
            class GraphManager,
            class Parameters = common::NoParameters,
-           class GraphParameters = common::NoParameters >
+           class GraphParameters = common::NoParameters,
+           class Scheduler = common::SchedulerType >
 class Coordinator : public pdevs::Coordinator < Time, GraphManager,
-                                                Parameters, GraphParameters >
+                                                Parameters, GraphParameters,
+                                                Scheduler >
 {
-    typedef pdevs::Coordinator < Time, GraphManager,
-                                 Parameters, GraphParameters > parent_type;
-    typedef Coordinator < Time, GraphManager,
-                          Parameters, GraphParameters > type;
-    typedef done_start_message < Time > done_start_message_type;
-    typedef start_message < Time > start_message_type;
-    typedef done_transition_message < Time > done_transition_message_type;
-    typedef transition_message < Time > transition_message_type;
+    typedef pdevs::Coordinator < Time, GraphManager, Parameters,
+                                 GraphParameters, Scheduler > parent_type;
+    typedef Coordinator < Time, GraphManager, Parameters, GraphParameters,
+                          Scheduler > type;
+    typedef Message < Time > message_type;
+
+    static const size_t MAILBOX_SIZE = 256;
+
+    // start or transition of a coupled child
+    struct Task : common::WorkerPool::Task
+    {
+        type*                           coordinator;
+        common::Model < Time >*         child;
+        typename message_type::Kind     kind;
+        typename Time::type             t;
+
+        void run()
+        {
+            message_type message = { kind, kind == message_type::DONE_START ?
+                                     child->start(t) : child->transition(t),
+                                     child };
+
+            // the mailbox is full: the coordinator empties it while it
+            // waits for the answers
+            while (not coordinator->_mailbox.push(message)) {
+                std::this_thread::yield();
+            }
+        }
+    };
 
 public:
     Coordinator(const std::string& name,
                 const Parameters& parameters,
-                const GraphParameters& graph_parameters) :
+                const GraphParameters& graph_parameters,
+                common::WorkerPool& pool = common::WorkerPool::pool()) :
         common::Model < Time >(name),
-        pdevs::Coordinator < Time, GraphManager,
-                             Parameters, GraphParameters >(name, parameters,
-                                                           graph_parameters)
-    {
-        type::_graph_manager.init();
-        _thread = new std::thread([&]{ loop(); });
-    }
+        parent_type(name, parameters, graph_parameters), _pool(pool)
+    { }
 
     virtual ~Coordinator()
-    {
-        done();
-        _thread->join();
-        delete _thread;
-    }
-
-    void done()
-    { get_sender().send(artis::common::Close()); }
-
-    artis::common::Sender get_sender()
-    { return _incoming; }
-
-    void set_sender(common::Sender sender)
-    { _sender = sender; }
+    { }
 
-    void loop()
+protected:
+    void start_children(const typename Time::type& t)
     {
-        try
-        {
-            for(;;) {
-                _incoming.wait()
-                    .template handle < start_message_type >(
-                        [&](start_message_type const& msg)
-                        {
-                            typename Time::type tn = start(msg._t);
-                            _sender.send(done_start_message_type(tn, this));
-                        })
-                    .template handle < done_start_message_type >(
-                        [&](done_start_message_type const& msg)
-                        {
-                            type::_event_table.init(msg._tn, msg._child);
-                            --_received;
-                            if (_received == 0) {
-                                _received_mutex.unlock();
-                            }
-                        })
-                    .template handle < transition_message_type >(
-                        [&](transition_message_type const& msg)
-                        {
-                            typename Time::type tn = transition(msg._t);
-                            _sender.send(done_transition_message_type(tn,
-                                                                      this));
-                        })
-                    .template handle < done_transition_message_type >(
-                        [&](done_transition_message_type const& msg)
-                        {
-                            type::_event_table.put(msg._tn, msg._child);
-                            --_received;
-                            if (_received == 0) {
-                                _received_mutex.unlock();
-                            }
-                        });
-            }
+        const common::Models < Time >& children =
+            type::_graph_manager.children();
+
+        _tns.resize(children.size());
+        _tasks.resize(children.size());
+        run(children, message_type::DONE_START, t);
+        for (auto & child : children) {
+            type::_event_table.init(_tns[child->get_child_index()], child);
         }
-        catch(artis::common::Close const&)
-        { }
     }
 
-    typename Time::type start(const typename Time::type& t)
+    void transition_children(const typename Time::type& t)
     {
-        _received = 0;
-        for (auto & child : parent_type::_graph_manager.children()) {
-            if (child->is_atomic()) {
-                type::_event_table.init(child->start(type::_tn), child);
-            } else {
-                ++_received;
-            }
-        }
+        common::Models < Time >& receivers = type::_imminents;
 
-        if (_received > 0) {
-            _received_mutex.lock();
-            type::_graph_manager.start(t);
-
-            std::lock_guard < std::mutex > lock(_received_mutex);
+        type::_event_table.get_current_models(t, receivers);
+        type::add_models_with_inputs(receivers);
+        run(receivers, message_type::DONE_TRANSITION, t);
+        for (auto & model : receivers) {
+            type::_event_table.put(_tns[model->get_child_index()], model);
         }
-
-        type::_tl = t;
-        type::_tn = type::_event_table.get_current_time();
-        return type::_tn;
+        parent_type::update_event_table(t);
+        type::_receivers.clear();
     }
 
-    // TODO: to remove
-    virtual int get_receiver_number(typename Time::type t)
-    { return type::_event_table.get_current_models(t).size(); }
-
-    typename Time::type transition(const typename Time::type& t)
+private:
+    // the next times of the models are written in _tns
+    void run(const common::Models < Time >& models,
+             typename message_type::Kind kind, const typename Time::type& t)
     {
-        assert(t >= type::_tl and t <= type::_tn);
+        unsigned int coupled_number = 0;
+        unsigned int waited = 0;
 
-        common::Models < Time > receivers =
-            type::_event_table.get_current_models(t);
-
-        type::add_models_with_inputs(receivers);
+        for (auto & model : models) {
+            if (not model->is_atomic()) {
+                ++coupled_number;
+            }
+        }
+        for (auto & model : models) {
+            unsigned int index = model->get_child_index();
 
-        _received = 0;
-        for (auto & model : receivers) {
-            if (model->is_atomic()) {
-                type::_event_table.put(model->transition(t), model);
+            if (model->is_atomic() or coupled_number == 1) {
+                _tns[index] = kind == message_type::DONE_START ?
+                    model->start(t) : model->transition(t);
             } else {
-                ++_received;
+                Task& task = _tasks[index];
+
+                task.coordinator = this;
+                task.child = model;
+                task.kind = kind;
+                task.t = t;
+                _pool.submit(&task);
+                ++waited;
             }
         }
+        while (waited > 0) {
+            message_type message;
 
-        if (_received > 0) {
-            _received_mutex.lock();
-            type::_graph_manager.transition(receivers, t);
+            if (_mailbox.pop(message)) {
+                assert(message.kind == kind);
 
-            std::lock_guard < std::mutex > lock(_received_mutex);
+                _tns[message.child->get_child_index()] = message.tn;
+                --waited;
+            } else if (not _pool.help()) {
+                std::this_thread::yield();
+            }
         }
-
-        parent_type::update_event_table(t);
-        type::_tl = t;
-        type::_tn = type::_event_table.get_current_time();
-        type::clear_bag();
-
-        return type::_tn;
     }
 
-private:
-    std::thread*               _thread;
-    artis::common::Receiver _incoming;
-    artis::common::Sender   _sender;
-    unsigned int               _received;
-    std::mutex                 _received_mutex;
+    common::WorkerPool&                            _pool;
+    common::Mailbox < message_type, MAILBOX_SIZE > _mailbox;
+    // by child index
+    std::vector < Task >                           _tasks;
+    std::vector < typename Time::type >            _tns;
 };
 
 } } } // namespace artis pdevs multithreading
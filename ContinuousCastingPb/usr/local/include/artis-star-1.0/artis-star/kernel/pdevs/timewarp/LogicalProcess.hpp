@@ -0,0 +1,518 @@
+/**
+ * @file kernel/pdevs/timewarp/LogicalProcess.hpp
+ * @author The ARTIS Development Team
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * ARTIS - the multimodeling and simulation environment
+ * This file is a part of the ARTIS environment
+ *
+ * Copyright (C) 2013-2018 ULCO http://www.univ-littoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PDEVS_TIMEWARP_LOGICAL_PROCESS
+#define PDEVS_TIMEWARP_LOGICAL_PROCESS 1
+
+#include <artis-star/common/Coordinator.hpp>
+#include <artis-star/common/Snapshot.hpp>
+#include <artis-star/common/Value.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace artis { namespace pdevs { namespace timewarp {
+
+/**
+ * Time of a step: the steps of a zero-time cascade have the same time and
+ * increasing indexes, as the steps of the root coordinator. A message
+ * sent by a step is received by the step with the same stamp.
+ */
+template < class Time >
+struct Stamp
+{
+    typename Time::type time;
+    int                 step;
+
+    bool operator<(const Stamp& other) const
+    { return time < other.time or (time == other.time and step < other.step); }
+
+    bool operator==(const Stamp& other) const
+    { return time == other.time and step == other.step; }
+
+    bool operator<=(const Stamp& other) const
+    { return not (other < *this); }
+};
+
+// event between two processes, an anti-message cancels the message with
+// the same sender and sequence
+template < class Time >
+struct Message
+{
+    Stamp < Time > stamp;
+    unsigned int   sender;
+    unsigned long  sequence;
+    unsigned int   port;
+    common::Value  content;
+    bool           anti;
+
+    // order of the events of a bag: the senders, then the emissions
+    bool operator<(const Message& other) const
+    {
+        return stamp < other.stamp or
+            (stamp == other.stamp and
+             (sender < other.sender or
+              (sender == other.sender and sequence < other.sequence)));
+    }
+};
+
+/**
+ * Optimistic simulation of a coupled model: the steps are made as soon as
+ * possible and a message not newer than the last step (straggler) rolls
+ * the model back to a saved state. The steps between this state and the
+ * straggler are made again without sending their messages (coast
+ * forward), the messages of the later steps are cancelled by
+ * anti-messages. The outputs of a step only depend on the state before
+ * it: the messages of the step of the straggler are kept too, else two
+ * processes exchanging messages at the same stamp would roll each other
+ * back forever; they are cancelled when a message older than them arrives
+ * before the step is made again. The events on the output ports of the
+ * model become messages to the linked processes.
+ *
+ * The inbox is written by the other processes, everything else belongs to
+ * the thread of the process or to the GVT computation.
+ */
+template < class Time >
+class LogicalProcess
+{
+    typedef Stamp < Time > stamp_type;
+    typedef Message < Time > message_type;
+
+    // parent of the model: receives the events on its output ports
+    class Parent : public common::Coordinator < Time >
+    {
+    public:
+        Parent(LogicalProcess* process) :
+            common::Model < Time >(process->_model->get_name()),
+            common::Coordinator < Time >(process->_model->get_name()),
+            _process(process)
+        { }
+
+        const common::GraphManager < Time >& get_graph_manager() const
+        { return _process->_model->get_graph_manager(); }
+
+        typename Time::type dispatch_events(const common::Bag < Time >& bag,
+                                            const typename Time::type& t)
+        {
+            for (auto & event : bag) {
+                _process->send(event.get_port_index(), event.data());
+            }
+            return t;
+        }
+
+        common::Value observe(const typename Time::type& /* t */,
+                              unsigned int /* index */) const
+        {
+            assert(false);
+            return common::Value();
+        }
+
+        void output(const typename Time::type& /* t */)
+        { assert(false); }
+
+        void post_event(const typename Time::type& /* t */,
+                        const common::ExternalEvent < Time >& /* event */)
+        { assert(false); }
+
+        typename Time::type start(const typename Time::type& t)
+        {
+            assert(false);
+            return t;
+        }
+
+        typename Time::type transition(const typename Time::type& t)
+        {
+            assert(false);
+            return t;
+        }
+
+    private:
+        LogicalProcess* _process;
+    };
+
+    struct Link
+    {
+        unsigned int    output_port;
+        LogicalProcess* destination;
+        unsigned int    input_port;
+    };
+
+    // message sent by a step, kept until it cannot be cancelled
+    struct Sent
+    {
+        stamp_type      stamp;
+        unsigned long   sequence;
+        LogicalProcess* destination;
+    };
+
+    struct State
+    {
+        stamp_type                                  last;
+        unsigned long                               history;
+        std::unique_ptr < common::Snapshot < Time > > snapshot;
+    };
+
+public:
+    // the model must not have a parent
+    LogicalProcess(unsigned int index, common::Coordinator < Time >* model) :
+        _index(index), _model(model), _parent(this), _state_interval(1),
+        _pending(false), _processed(0), _sequence(0), _history(0),
+        _unsaved(0), _step_number(0), _rollback_number(0),
+        _anti_message_number(0)
+    {
+        assert(model->get_parent() == nullptr);
+
+        // the steps of the zero-time cascades are made by the process
+        model->set_parent(&_parent);
+    }
+
+    void add_link(unsigned int output_port, LogicalProcess* destination,
+                  unsigned int input_port)
+    { _links.push_back({ output_port, destination, input_port }); }
+
+    unsigned int index() const
+    { return _index; }
+
+    const common::Coordinator < Time >* model() const
+    { return _model; }
+
+    // a state is saved every state_interval steps
+    void start(const typename Time::type& t, unsigned int state_interval)
+    {
+        _state_interval = std::max(1U, state_interval);
+        _inbox.clear();
+        _pending.store(false);
+        _inputs.clear();
+        _processed = 0;
+        _outputs.clear();
+        while (not _states.empty()) {
+            recycle(_states.back());
+            _states.pop_back();
+        }
+        _model->start(t);
+        _last = { t, -1 };
+        _sent = _last;
+        _history = 0;
+        _unsaved = 0;
+        _step_number = 0;
+        _rollback_number = 0;
+        _anti_message_number = 0;
+        // the first rollbacks go back to the start: the event table of the
+        // model must be saved with its order (IndexedSchedulerType)
+        save();
+        if (_states.empty()) {
+            throw std::logic_error("LogicalProcess: the initial state of " +
+                                   _model->get_name() + " cannot be saved");
+        }
+    }
+
+    // stamp of the next step
+    stamp_type next() const
+    {
+        typename Time::type tn = _model->get_tn();
+        stamp_type internal = tn == _last.time ?
+            stamp_type{ tn, _last.step + 1 } : stamp_type{ tn, 0 };
+
+        if (_processed < _inputs.size() and
+            _inputs[_processed].stamp < internal) {
+            return _inputs[_processed].stamp;
+        }
+        return internal;
+    }
+
+    // outputs of the imminent children and inputs with the stamp of the
+    // step, then transition
+    void step()
+    {
+        stamp_type stamp = next();
+
+        if (_unsaved >= _state_interval) {
+            save();
+        }
+        _current = stamp;
+        if (_model->get_tn() == stamp.time) {
+            _model->output(stamp.time);
+        }
+        while (_processed < _inputs.size() and
+               _inputs[_processed].stamp == stamp) {
+            const message_type& message = _inputs[_processed];
+
+            _model->post_event(stamp.time, common::ExternalEvent < Time >(
+                                   common::Node < Time >(
+                                       _model, message.port),
+                                   message.content));
+            ++_processed;
+        }
+        _model->transition(stamp.time);
+        _last = stamp;
+        ++_history;
+        ++_unsaved;
+        ++_step_number;
+    }
+
+    // messages of the other processes, false if none
+    bool receive()
+    {
+        if (not _pending.load(std::memory_order_acquire)) {
+            return false;
+        }
+        {
+            std::lock_guard < std::mutex > lock(_mutex);
+
+            _arrivals.swap(_inbox);
+            _pending.store(false, std::memory_order_relaxed);
+        }
+        for (const message_type& message : _arrivals) {
+            if (message.anti) {
+                annihilate(message);
+            } else {
+                insert(message);
+            }
+        }
+        _arrivals.clear();
+        return true;
+    }
+
+    // nothing older than gvt can be rolled back
+    void fossil_collect(const stamp_type& gvt)
+    {
+        size_t kept = _states.size() - 1;
+
+        while (kept > 0 and not (_states[kept].last < gvt)) {
+            --kept;
+        }
+        for (size_t i = 0; i < kept; ++i) {
+            recycle(_states.front());
+            _states.pop_front();
+        }
+
+        const stamp_type& oldest = _states.front().last;
+
+        while (not _inputs.empty() and _inputs.front().stamp <= oldest) {
+            _inputs.pop_front();
+            --_processed;
+        }
+        while (not _outputs.empty() and _outputs.front().stamp <= oldest) {
+            _outputs.pop_front();
+        }
+    }
+
+    // steps made, including the cancelled ones and the coast forwards
+    unsigned long step_number() const
+    { return _step_number; }
+
+    // steps of the current history
+    unsigned long history() const
+    { return _history; }
+
+    unsigned long rollback_number() const
+    { return _rollback_number; }
+
+    unsigned long anti_message_number() const
+    { return _anti_message_number; }
+
+private:
+    void deliver(const message_type& message)
+    {
+        std::lock_guard < std::mutex > lock(_mutex);
+
+        _inbox.push_back(message);
+        _pending.store(true, std::memory_order_release);
+    }
+
+    // event on an output port of the model during the current step
+    void send(unsigned int port, const common::Value& content)
+    {
+        // the step is made again after a rollback
+        if (_current <= _sent) {
+            return;
+        }
+        for (const Link& link : _links) {
+            if (link.output_port == port) {
+                message_type message = { _current, _index, _sequence++,
+                                         link.input_port, content, false };
+
+                // a message to the process is received by the current step
+                if (link.destination == this) {
+                    _inputs.insert(std::upper_bound(_inputs.begin(),
+                                                    _inputs.end(), message),
+                                   message);
+                } else {
+                    link.destination->deliver(message);
+                }
+                _outputs.push_back({ _current, message.sequence,
+                                     link.destination });
+            }
+        }
+    }
+
+    void insert(const message_type& message)
+    {
+        if (message.stamp <= _last) {
+            rollback(message.stamp);
+        } else if (message.stamp < _sent) {
+            cancel(message.stamp);
+        }
+        _inputs.insert(std::upper_bound(_inputs.begin(), _inputs.end(),
+                                        message), message);
+    }
+
+    void annihilate(const message_type& anti)
+    {
+        if (anti.stamp <= _last) {
+            rollback(anti.stamp);
+        } else if (anti.stamp < _sent) {
+            cancel(anti.stamp);
+        }
+
+        // the message arrived before its anti-message (same inbox)
+        auto it = std::lower_bound(_inputs.begin() + _processed,
+                                   _inputs.end(), anti);
+
+        assert(it != _inputs.end() and it->sender == anti.sender and
+               it->sequence == anti.sequence);
+
+        _inputs.erase(it);
+    }
+
+    // the messages sent by the steps after stamp are cancelled: a message
+    // older than the kept ones changes the state they were computed from
+    void cancel(const stamp_type& stamp)
+    {
+        while (not _outputs.empty() and stamp < _outputs.back().stamp) {
+            const Sent& sent = _outputs.back();
+            message_type anti = { sent.stamp, _index, sent.sequence, 0,
+                                  common::Value(), true };
+
+            if (sent.destination == this) {
+                _inputs.erase(std::lower_bound(_inputs.begin(), _inputs.end(),
+                                               anti));
+            } else {
+                sent.destination->deliver(anti);
+                ++_anti_message_number;
+            }
+            _outputs.pop_back();
+        }
+        _sent = stamp;
+    }
+
+    // the steps from stamp are cancelled
+    void rollback(const stamp_type& stamp)
+    {
+        ++_rollback_number;
+        cancel(stamp);
+        while (_states.size() > 1 and stamp <= _states.back().last) {
+            recycle(_states.back());
+            _states.pop_back();
+        }
+
+        State& state = _states.back();
+
+        assert(state.last < stamp);
+
+        state.snapshot->rewind();
+        _model->restore(*state.snapshot);
+        _last = state.last;
+        _history = state.history;
+        _unsaved = 0;
+        _processed = std::upper_bound(_inputs.begin(), _inputs.end(),
+                                      message_type{ _last, ~0U, ~0UL, 0,
+                                                    common::Value(), false })
+            - _inputs.begin();
+        while (next() < stamp) {
+            step();
+        }
+    }
+
+    void save()
+    {
+        std::unique_ptr < common::Snapshot < Time > > snapshot;
+
+        if (_snapshots.empty()) {
+            snapshot.reset(new common::Snapshot < Time >);
+        } else {
+            snapshot = std::move(_snapshots.back());
+            _snapshots.pop_back();
+        }
+        snapshot->clear();
+        _model->save(*snapshot);
+        if (snapshot->valid()) {
+            _states.push_back(State());
+            _states.back().last = _last;
+            _states.back().history = _history;
+            _states.back().snapshot = std::move(snapshot);
+            _unsaved = 0;
+        } else {
+            // retried at the next step
+            _snapshots.push_back(std::move(snapshot));
+        }
+    }
+
+    // the entries of the snapshots are reused by the next saves
+    void recycle(State& state)
+    { _snapshots.push_back(std::move(state.snapshot)); }
+
+    unsigned int                  _index;
+    common::Coordinator < Time >* _model;
+    Parent                        _parent;
+    std::vector < Link >          _links;
+    unsigned int                  _state_interval;
+
+    // written by the other processes
+    std::mutex                    _mutex;
+    std::vector < message_type >  _inbox;
+    std::atomic < bool >          _pending;
+
+    std::vector < message_type >  _arrivals;
+    // sorted, the first _processed ones are received by the steps
+    std::deque < message_type >   _inputs;
+    size_t                        _processed;
+    std::deque < Sent >           _outputs;
+    unsigned long                 _sequence;
+    std::deque < State >          _states;
+    std::vector < std::unique_ptr < common::Snapshot < Time > > > _snapshots;
+
+    stamp_type                    _last;
+    stamp_type                    _current;
+    unsigned long                 _history;
+    unsigned int                  _unsaved;
+    // the messages of the steps until _sent are sent
+    stamp_type                    _sent;
+
+    unsigned long                 _step_number;
+    unsigned long                 _rollback_number;
+    unsigned long                 _anti_message_number;
+};
+
+} } } // namespace artis pdevs timewarp
+
+#endif
@@ -0,0 +1,270 @@
+/**
+ * @file kernel/pdevs/timewarp/RootCoordinator.hpp
+ * @author The ARTIS Development Team
+ * See the AUTHORS or Authors.txt file
+ */
+
+/*
+ * ARTIS - the multimodeling and simulation environment
+ * This file is a part of the ARTIS environment
+ *
+ * Copyright (C) 2013-2018 ULCO http://www.univ-littoral.fr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PDEVS_TIMEWARP_ROOT_COORDINATOR
+#define PDEVS_TIMEWARP_ROOT_COORDINATOR 1
+
+#include <artis-star/common/Scheduler.hpp>
+#include <artis-star/kernel/pdevs/timewarp/LogicalProcess.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace artis { namespace pdevs { namespace timewarp {
+
+struct Statistics
+{
+    // steps made, including the cancelled ones and the coast forwards
+    unsigned long step_number;
+    // steps of the simulation
+    unsigned long committed_step_number;
+    unsigned long rollback_number;
+    unsigned long anti_message_number;
+    unsigned long gvt_number;
+};
+
+/**
+ * Time Warp simulation of coupled models (the logical processes, a caster
+ * line or a yard for instance) linked by their ports, on several threads.
+ * Each thread makes the steps of its processes in the order of their
+ * stamps. The global virtual time is computed when a thread asks for it
+ * (every gvt_interval steps or when it is idle): the threads stop, the
+ * messages in transit are received, GVT is the oldest next step and the
+ * states, inputs and outputs older than GVT are released. The simulation
+ * ends when GVT passes t_max: the models are then in their states at
+ * t_max, the same as with a pdevs::Coordinator of the processes.
+ */
+template < class Time >
+class RootCoordinator
+{
+    typedef LogicalProcess < Time > process_type;
+    typedef Stamp < Time > stamp_type;
+
+    // idle loops of a thread before it asks for the GVT
+    static const unsigned int IDLE_LOOP_NUMBER = 256;
+
+public:
+    RootCoordinator(const typename Time::type& t_start,
+                    const typename Time::type& t_max) :
+        _t_start(t_start), _t_max(t_max), _state_interval(1),
+        _gvt_interval(1024), _window(Time::infinity), _thread_number(1),
+        _gvt_requested(false), _arrived(0), _generation(0), _done(false),
+        _gvt_number(0)
+    { }
+
+    // the processes are ordered as their additions, like the children of
+    // a coordinator: the events of a bag are ordered by sender
+    template < class Model >
+    unsigned int add_process(Model* model)
+    {
+        static_assert(not std::is_same < typename Model::scheduler_type,
+                                         common::SchedulerType >::value,
+                      "the state of a process is saved with its event "
+                      "table, use IndexedSchedulerType");
+
+        _processes.push_back(std::unique_ptr < process_type >(
+                                 new process_type(_processes.size(),
+                                                  model)));
+        return _processes.size() - 1;
+    }
+
+    void add_link(unsigned int source, unsigned int output_port,
+                  unsigned int destination, unsigned int input_port)
+    {
+        _processes[source]->add_link(output_port,
+                                     _processes[destination].get(),
+                                     input_port);
+    }
+
+    // a state is saved every interval steps of a process, the others are
+    // rebuilt by coast forward
+    void set_state_interval(unsigned int interval)
+    { _state_interval = interval; }
+
+    void set_gvt_interval(unsigned int interval)
+    { _gvt_interval = std::max(1U, interval); }
+
+    // the processes do not go further than GVT + window
+    void set_window(const typename Time::type& window)
+    { _window = window; }
+
+    void run(unsigned int thread_number)
+    {
+        std::vector < std::thread > threads;
+
+        _thread_number = std::max(1U, std::min(thread_number,
+                                               (unsigned int)
+                                               _processes.size()));
+        for (auto & process : _processes) {
+            process->start(_t_start, _state_interval);
+        }
+        _gvt = { _t_start, -1 };
+        _done = false;
+        _gvt_requested = false;
+        _arrived = 0;
+        _gvt_number = 0;
+        for (unsigned int i = 1; i < _thread_number; ++i) {
+            threads.push_back(std::thread(&RootCoordinator::work, this, i));
+        }
+        work(0);
+        for (std::thread & thread : threads) {
+            thread.join();
+        }
+    }
+
+    Statistics statistics() const
+    {
+        Statistics statistics = { 0, 0, 0, 0, _gvt_number };
+
+        for (auto & process : _processes) {
+            statistics.step_number += process->step_number();
+            statistics.committed_step_number += process->history();
+            statistics.rollback_number += process->rollback_number();
+            statistics.anti_message_number += process->anti_message_number();
+        }
+        return statistics;
+    }
+
+private:
+    void work(unsigned int index)
+    {
+        unsigned int step_number = 0;
+        unsigned int idle_number = 0;
+
+        while (true) {
+            if (_gvt_requested.load(std::memory_order_acquire)) {
+                if (not synchronize()) {
+                    return;
+                }
+                step_number = 0;
+                idle_number = 0;
+            }
+
+            process_type* next = nullptr;
+            stamp_type stamp;
+            typename Time::type limit = std::min(_t_max, _gvt.time + _window);
+
+            for (size_t i = index; i < _processes.size();
+                 i += _thread_number) {
+                process_type* process = _processes[i].get();
+
+                process->receive();
+
+                stamp_type candidate = process->next();
+
+                if (candidate.time <= limit and
+                    (next == nullptr or candidate < stamp)) {
+                    next = process;
+                    stamp = candidate;
+                }
+            }
+            if (next) {
+                next->step();
+                ++step_number;
+            } else {
+                ++idle_number;
+                std::this_thread::yield();
+            }
+            if (step_number >= _gvt_interval or
+                idle_number >= IDLE_LOOP_NUMBER) {
+                _gvt_requested.store(true, std::memory_order_release);
+            }
+        }
+    }
+
+    // barrier of the threads, the last one computes GVT, false at the end
+    bool synchronize()
+    {
+        std::unique_lock < std::mutex > lock(_mutex);
+        unsigned long generation = _generation;
+
+        if (++_arrived == _thread_number) {
+            compute_gvt();
+            _arrived = 0;
+            ++_generation;
+            _gvt_requested.store(false, std::memory_order_release);
+            _condition.notify_all();
+        } else {
+            _condition.wait(lock, [this, generation]() {
+                    return _generation != generation; });
+        }
+        return not _done;
+    }
+
+    // all the threads wait
+    void compute_gvt()
+    {
+        bool received = true;
+
+        // the rollbacks send anti-messages
+        while (received) {
+            received = false;
+            for (auto & process : _processes) {
+                received = process->receive() or received;
+            }
+        }
+        _gvt = _processes[0]->next();
+        for (auto & process : _processes) {
+            stamp_type next = process->next();
+
+            if (next < _gvt) {
+                _gvt = next;
+            }
+        }
+        for (auto & process : _processes) {
+            process->fossil_collect(_gvt);
+        }
+        ++_gvt_number;
+        _done = _gvt.time > _t_max;
+    }
+
+    typename Time::type                           _t_start;
+    typename Time::type                           _t_max;
+    unsigned int                                  _state_interval;
+    unsigned int                                  _gvt_interval;
+    typename Time::type                           _window;
+    std::vector < std::unique_ptr < process_type > > _processes;
+    unsigned int                                  _thread_number;
+
+    std::atomic < bool >                          _gvt_requested;
+    std::mutex                                    _mutex;
+    std::condition_variable                       _condition;
+    unsigned int                                  _arrived;
+    unsigned long                                 _generation;
+    bool                                          _done;
+    stamp_type                                    _gvt;
+    unsigned long                                 _gvt_number;
+};
+
+} } } // namespace artis pdevs timewarp
+
+#endif